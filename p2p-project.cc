@@ -1,4 +1,5 @@
 #include "simulation/configuration.h"
+#include "simulation/paired-comparison.h"
 #include "simulation/simulator-helper.h"
 #include "simulation/tracer.h"
 
@@ -19,6 +20,14 @@ main(int argc, char* argv[])
     ParseConsoleArgs(conf, argc, argv);
     InitializeDefaultConfiguration(conf);
 
+    // Compare the variants with paired runs sharing the same losses
+    if (conf.paired_runs > 0)
+    {
+        PairedComparison pairedComparison(conf);
+        pairedComparison.Run();
+        return 0;
+    }
+
     // Set up tracing
     Tracer tracer(conf, GraphDataUpdateType::All);
 
@@ -26,8 +35,8 @@ main(int argc, char* argv[])
     simHelper.Setup();
 
     NS_LOG_INFO("Run Simulation");
-    simHelper.Run();
-    NS_LOG_INFO("The simulation has ended");
+    SimulationResult result = simHelper.Run();
+    NS_LOG_INFO("The simulation has ended at " << result.endTime << " s");
 
     return 0;
 }
@@ -0,0 +1,141 @@
+#include "ack-thinning-queue-disc.h"
+
+#include "ns3/drop-tail-queue.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/tcp-header.h"
+
+NS_LOG_COMPONENT_DEFINE("AckThinningQueueDisc");
+NS_OBJECT_ENSURE_REGISTERED(AckThinningQueueDisc);
+
+TypeId
+AckThinningQueueDisc::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::AckThinningQueueDisc")
+            .SetParent<QueueDisc>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<AckThinningQueueDisc>()
+            .AddAttribute("MaxSize",
+                          "The max queue size",
+                          QueueSizeValue(QueueSize("1000p")),
+                          MakeQueueSizeAccessor(&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
+                          MakeQueueSizeChecker());
+    return tid;
+}
+
+AckThinningQueueDisc::AckThinningQueueDisc()
+    : QueueDisc(QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+AckThinningQueueDisc::IsPureAck(Ptr<const QueueDiscItem> item,
+                                uint64_t& connection,
+                                SequenceNumber32& ack)
+{
+    Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem>(item);
+    if (!ipv4Item || ipv4Item->GetHeader().GetProtocol() != 6)
+        return false;
+
+    TcpHeader header;
+    Ptr<Packet> packet = item->GetPacket();
+    if (packet->PeekHeader(header) == 0 || packet->GetSize() != header.GetSerializedSize())
+        return false;
+    uint8_t flags = header.GetFlags();
+    if (!(flags & TcpHeader::ACK) ||
+        (flags & (TcpHeader::SYN | TcpHeader::FIN | TcpHeader::RST)))
+        return false;
+
+    // The destination address and port identify the connection on the sender
+    connection = static_cast<uint64_t>(ipv4Item->GetHeader().GetDestination().Get()) << 16 |
+                 header.GetDestinationPort();
+    ack = header.GetAckNumber();
+    return true;
+}
+
+bool
+AckThinningQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+
+    if (GetCurrentSize() + item > GetMaxSize())
+    {
+        NS_LOG_LOGIC("Queue full -- dropping pkt");
+        DropBeforeEnqueue(item, LIMIT_EXCEEDED_DROP);
+        return false;
+    }
+    if (!GetInternalQueue(0)->Enqueue(item))
+        return false;
+
+    uint64_t connection;
+    SequenceNumber32 ack;
+    if (IsPureAck(item, connection, ack))
+    {
+        QueuedAcks& queued = m_queuedAcks[connection];
+        if (queued.count++ == 0 || ack > queued.highest)
+            queued.highest = ack;
+    }
+    return true;
+}
+
+Ptr<QueueDiscItem>
+AckThinningQueueDisc::DoDequeue()
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<QueueDiscItem> item;
+    while ((item = GetInternalQueue(0)->Dequeue()))
+    {
+        uint64_t connection;
+        SequenceNumber32 ack;
+        if (!IsPureAck(item, connection, ack))
+            return item;
+
+        auto it = m_queuedAcks.find(connection);
+        bool superseded = --it->second.count > 0 && it->second.highest > ack;
+        if (it->second.count == 0)
+            m_queuedAcks.erase(it);
+        if (!superseded)
+            return item;
+        NS_LOG_LOGIC("ACK " << ack << " superseded by " << it->second.highest);
+        DropAfterDequeue(item, THINNED_ACK_DROP);
+    }
+    NS_LOG_LOGIC("Queue empty");
+    return nullptr;
+}
+
+bool
+AckThinningQueueDisc::CheckConfig()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (GetNQueueDiscClasses() > 0)
+    {
+        NS_LOG_ERROR("AckThinningQueueDisc cannot have classes");
+        return false;
+    }
+    if (GetNPacketFilters() > 0)
+    {
+        NS_LOG_ERROR("AckThinningQueueDisc needs no packet filter");
+        return false;
+    }
+    if (GetNInternalQueues() == 0)
+    {
+        AddInternalQueue(
+            CreateObjectWithAttributes<DropTailQueue<QueueDiscItem>>("MaxSize",
+                                                                     QueueSizeValue(GetMaxSize())));
+    }
+    if (GetNInternalQueues() != 1)
+    {
+        NS_LOG_ERROR("AckThinningQueueDisc needs 1 internal queue");
+        return false;
+    }
+    return true;
+}
+
+void
+AckThinningQueueDisc::InitializeParams()
+{
+    NS_LOG_FUNCTION(this);
+}
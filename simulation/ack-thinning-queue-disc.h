@@ -0,0 +1,68 @@
+#ifndef P2P_SIMULATION_ACK_THINNING_QUEUE_DISC_H
+#define P2P_SIMULATION_ACK_THINNING_QUEUE_DISC_H
+
+#include "ns3/core-module.h"
+#include "ns3/queue-disc.h"
+#include "ns3/sequence-number.h"
+
+#include <map>
+
+using namespace ns3;
+
+/**
+ * @brief AckThinningQueueDisc class.
+ * FIFO queue disc that thins the pure ACKs of the TCP connections, like the ACK filters of
+ * asymmetric access links. When a pure ACK reaches the head of the queue while a pure ACK of the
+ * same connection with a higher ack number is still queued behind it, it is dropped, since the
+ * cumulative ACK behind it carries the same information. The duplicate ACKs all have the same ack
+ * number, so they are never thinned and the fast retransmit still works.
+ * The ACKs are thinned at dequeue, so the order of the packets is preserved.
+ */
+class AckThinningQueueDisc : public QueueDisc
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * @brief AckThinningQueueDisc constructor.
+     */
+    AckThinningQueueDisc();
+
+    static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";
+    static constexpr const char* THINNED_ACK_DROP = "ACK superseded by a later one";
+
+  private:
+    /**
+     * @brief Pure ACKs of a connection in the queue.
+     */
+    struct QueuedAcks
+    {
+        uint32_t count = 0;       //!< Pure ACKs queued.
+        SequenceNumber32 highest; //!< Highest ack number queued.
+    };
+
+    bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+    Ptr<QueueDiscItem> DoDequeue() override;
+    bool CheckConfig() override;
+    void InitializeParams() override;
+
+    /**
+     * @brief Check if a packet is a pure ACK: a TCP segment without payload, SYN, FIN or RST.
+     * @param item packet.
+     * @param connection output parameter, key of the connection the ACK belongs to.
+     * @param ack output parameter, ack number of the ACK.
+     * @return true for a pure ACK.
+     */
+    static bool IsPureAck(Ptr<const QueueDiscItem> item,
+                          uint64_t& connection,
+                          SequenceNumber32& ack);
+
+  private:
+    std::map<uint64_t, QueuedAcks> m_queuedAcks; //!< Pure ACKs queued, by connection.
+};
+
+#endif /* P2P_SIMULATION_ACK_THINNING_QUEUE_DISC_H */
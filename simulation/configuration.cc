@@ -1,5 +1,15 @@
 #include "configuration.h"
 
+#include "ns3/tcp-bbr.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-cubic.h"
+#include "ns3/tcp-linux-reno.h"
+#include "ns3/tcp-prr-recovery.h"
+#include "ns3/tcp-recovery-ops.h"
+
+#include <limits>
+#include <sstream>
+
 NS_LOG_COMPONENT_DEFINE("Configuration");
 
 static uint32_t
@@ -36,6 +46,9 @@ SetTcpAttributes(const Configuration& conf)
     Config::SetDefault("ns3::TcpSocket::TcpNoDelay", BooleanValue(!conf.nagle));
     // Enable SACK
     Config::SetDefault("ns3::TcpSocketBase::Sack", BooleanValue(conf.sack));
+    // Delayed ACKs of the receivers
+    Config::SetDefault("ns3::TcpSocket::DelAckCount", UintegerValue(conf.delack_count));
+    Config::SetDefault("ns3::TcpSocket::DelAckTimeout", TimeValue(Seconds(conf.delack_timeout)));
 }
 
 static void
@@ -44,37 +57,102 @@ SetQueueAttributes(const Configuration& conf)
     // The maximum number of packets that can be queued
     Config::SetDefault("ns3::RedQueueDisc::MaxSize",
                        StringValue(std::to_string(conf.tcp_queue_size) + "p"));
+    Config::SetDefault("ns3::AckThinningQueueDisc::MaxSize",
+                       StringValue(std::to_string(conf.tcp_queue_size) + "p"));
 }
 
 std::ostream&
 operator<<(std::ostream& os, const Configuration& conf)
 {
+    // The resolved variant groups, which come from variant_mix or n_tcp_tahoe and n_tcp_reno
+    std::ostringstream variants;
+    for (const auto& [variant, n] : conf.variant_groups)
+        variants << (variants.tellp() > 0 ? ", " : "") << variant << ": " << n;
     return os << "Configuration: {" << std::endl
-              << "\tNumber of Tcp Tahoe nodes: " << conf.n_tcp_tahoe << std::endl
-              << "\tNumber of Tcp Reno nodes: " << conf.n_tcp_reno << std::endl
+              << "\tSenders: " << variants.str() << std::endl
+              << "\tSwap variants: " << conf.swap_variants << std::endl
               << "\tError probability: " << conf.error_p << std::endl
+              << "\tError model: " << conf.error_model << " on " << conf.error_links << std::endl
               << "\tSender bandwidth: " << conf.s_bandwidth << std::endl
               << "\tSender delay " << conf.s_delay << std::endl
               << "\tReceiver bandwidth: " << conf.r_bandwidth << std::endl
               << "\tReceiver delay: " << conf.r_delay << std::endl
+              << "\tReceivers: " << conf.n_receivers << " x " << conf.sink_ports << " ports"
+              << std::endl
               << "\tTracing: " << conf.ascii_tracing << std::endl
               << "\tPrefix file name: " << conf.prefix_file_name << std::endl
               << "\tMegabytes to send (MB): " << conf.max_mbytes_to_send << std::endl
               << "\tMTU (bytes): " << conf.mtu_bytes << std::endl
               << "\tDuration (s): " << conf.duration << std::endl
+              << "\tWorkload: " << conf.workload << std::endl
               << "\tRun: " << conf.run << std::endl
               << "\tGraph output: " << conf.graph_output << std::endl
               << "\tSack: " << conf.sack << std::endl
+              << "\tDelayed ACKs: " << conf.delack_count << " segments, " << conf.delack_timeout
+              << " s" << std::endl
               << "\tPcap: " << conf.pcap_tracing << std::endl
               << "}" << std::endl;
 }
 
+const TcpVariant&
+GetTcpVariant(const std::string& name)
+{
+    static const std::vector<TcpVariant> variants = {
+        {"tahoe", &TcpTahoe::GetTypeId, &TcpTahoeLossRecovery::GetTypeId},
+        {"reno", &TcpLinuxReno::GetTypeId, &TcpClassicRecovery::GetTypeId},
+        {"newreno", &TcpNewReno::GetTypeId, &TcpClassicRecovery::GetTypeId},
+        {"cubic", &TcpCubic::GetTypeId, &TcpPrrRecovery::GetTypeId},
+        // BBR sets a pacing rate, which the socket ignores unless pacing is enabled
+        {"bbr", &TcpBbr::GetTypeId, &TcpPrrRecovery::GetTypeId, true}};
+    for (const TcpVariant& variant : variants)
+    {
+        if (variant.name == name)
+            return variant;
+    }
+    NS_ABORT_MSG("Unknown TCP variant " << name);
+    return variants.front();
+}
+
+uint32_t
+GetFlowCount(const Configuration& conf)
+{
+    uint32_t count = 0;
+    for (const auto& [variant, n] : conf.variant_groups)
+        count += n;
+    return count;
+}
+
+std::string
+GetFlowVariant(const Configuration& conf, uint32_t flow)
+{
+    for (const auto& [variant, n] : conf.variant_groups)
+    {
+        if (flow >= n)
+        {
+            flow -= n;
+            continue;
+        }
+        if (conf.swap_variants && (variant == "tahoe" || variant == "reno"))
+            return variant == "tahoe" ? "reno" : "tahoe";
+        return variant;
+    }
+    NS_ABORT_MSG("Flow " << flow << " has no TCP variant");
+    return "";
+}
+
 void
 ParseConsoleArgs(Configuration& conf, int argc, char* argv[])
 {
     CommandLine cmd(__FILE__);
     cmd.AddValue("n_tcp_tahoe", "Number of Tcp Tahoe nodes", conf.n_tcp_tahoe);
     cmd.AddValue("n_tcp_reno", "Number of Tcp Reno nodes", conf.n_tcp_reno);
+    cmd.AddValue("swap_variants",
+                 "Tahoe nodes use Reno and Reno nodes use Tahoe",
+                 conf.swap_variants);
+    cmd.AddValue("variant_mix",
+                 "Senders of each TCP variant, e.g. 'tahoe:10,reno:10,cubic:5', overrides "
+                 "n_tcp_tahoe and n_tcp_reno",
+                 conf.variant_mix);
     cmd.AddValue("s_buf_size", "Sender buffer size (bytes)", conf.snd_buf_size);
     cmd.AddValue("r_buf_size", "Receiver buffer size (bytes)", conf.rcv_buf_size);
     cmd.AddValue("cwnd", "Initial congestion window (segments)", conf.initial_cwnd);
@@ -82,28 +160,214 @@ ParseConsoleArgs(Configuration& conf, int argc, char* argv[])
     cmd.AddValue("mtu", "Size of IP packets to send (bytes)", conf.mtu_bytes);
     cmd.AddValue("sack", "Enable SACK", conf.sack);
     cmd.AddValue("nagle", "Enable Nagle's algorithm", conf.nagle);
+    cmd.AddValue("delack_count",
+                 "Segments received before the receiver sends an ACK, 1 to disable delayed ACKs",
+                 conf.delack_count);
+    cmd.AddValue("delack_timeout", "Timeout of the delayed ACKs (s)", conf.delack_timeout);
     cmd.AddValue("error_p", "Packet error rate", conf.error_p);
     cmd.AddValue("s_bandwidth", "Sender link bandwidth", conf.s_bandwidth);
     cmd.AddValue("s_delay", "Sender link delay", conf.s_delay);
     cmd.AddValue("r_bandwidth", "Receiver link bandwidth", conf.r_bandwidth);
     cmd.AddValue("r_delay", "Receiver link delay", conf.r_delay);
+    cmd.AddValue("n_receivers",
+                 "Receiver nodes the flows are spread across, behind the bottleneck",
+                 conf.n_receivers);
+    cmd.AddValue("sink_ports", "Ports with a sink on each receiver node", conf.sink_ports);
     cmd.AddValue("tcp_queue_size", "TCP queue size (packets)", conf.tcp_queue_size);
+    cmd.AddValue("error_model", "Loss model: rate, gilbert-elliott, trace", conf.error_model);
+    cmd.AddValue("error_links",
+                 "Links using the loss model: receiver, senders, all",
+                 conf.error_links);
+    cmd.AddValue("ge_p_good_bad",
+                 "Probability of moving from the good to the bad state (gilbert-elliott)",
+                 conf.ge_p_good_bad);
+    cmd.AddValue("ge_p_bad_good",
+                 "Probability of moving from the bad to the good state (gilbert-elliott)",
+                 conf.ge_p_bad_good);
+    cmd.AddValue("ge_loss_good",
+                 "Packet loss probability in the good state (gilbert-elliott)",
+                 conf.ge_loss_good);
+    cmd.AddValue("ge_loss_bad",
+                 "Packet loss probability in the bad state (gilbert-elliott)",
+                 conf.ge_loss_bad);
+    cmd.AddValue("error_trace",
+                 "File with a 0 (received) or 1 (lost) for each packet (trace)",
+                 conf.error_trace);
+    cmd.AddValue("error_trace_loop",
+                 "Start the loss trace over when it ends, instead of losing no packet (trace)",
+                 conf.error_trace_loop);
+    cmd.AddValue("workload", "Traffic of the senders: bulk, poisson", conf.workload);
+    cmd.AddValue("flow_arrival_rate",
+                 "Mean number of new flows per second on each sender (poisson)",
+                 conf.flow_arrival_rate);
+    cmd.AddValue("flow_size_dist",
+                 "Flow size distribution: pareto, empirical (poisson)",
+                 conf.flow_size_dist);
+    cmd.AddValue("flow_size_mean", "Mean flow size (bytes) (pareto)", conf.flow_size_mean);
+    cmd.AddValue("flow_size_shape", "Shape of the flow size distribution (pareto)",
+                 conf.flow_size_shape);
+    cmd.AddValue("flow_size_cdf",
+                 "File with the flow size CDF, one '<bytes> <cdf>' per line (empirical)",
+                 conf.flow_size_cdf);
+    cmd.AddValue("connection_reuse",
+                 "Send new flows on idle connections (poisson)",
+                 conf.connection_reuse);
+    cmd.AddValue("max_connections",
+                 "Maximum number of connections of each sender (poisson)",
+                 conf.max_connections);
     cmd.AddValue("run", "Run id", conf.run);
-    cmd.AddValue("duration", "Duration of the simulation (s)", conf.duration);
+    cmd.AddValue("duration",
+                 "Duration of the simulation (s), 0 to run until all the transfers complete",
+                 conf.duration);
     cmd.AddValue("max_mbytes_to_send",
                  "Maximum number of megabytes to send (MB)",
                  conf.max_mbytes_to_send);
+    cmd.AddValue("max_duration",
+                 "Simulated time after which a run without a duration stops anyway (s)",
+                 conf.max_duration);
+    cmd.AddValue("start_schedule",
+                 "Start of the senders: none, stagger, jitter, trace",
+                 conf.start_schedule);
+    cmd.AddValue("start_stagger", "Time between the start of two senders (s)", conf.start_stagger);
+    cmd.AddValue("start_jitter", "Maximum random delay of the start of a sender (s)",
+                 conf.start_jitter);
+    cmd.AddValue("start_trace", "File with the start time of each sender (s)", conf.start_trace);
+    cmd.AddValue("link_schedule",
+                 "Changes of the receiver link, '<t>:<rate>[:<delay>]' separated by commas",
+                 conf.link_schedule);
+    cmd.AddValue("link_trace",
+                 "File with the changes of the receiver link, '<t> <rate> [<delay>]' per line",
+                 conf.link_trace);
+    cmd.AddValue("reconvergence_window",
+                 "Window of the reconvergence measurement after a capacity change (s)",
+                 conf.reconvergence_window);
+    cmd.AddValue("reconvergence_tolerance",
+                 "Maximum distance of the throughput from the capacity to reconverge, relative",
+                 conf.reconvergence_tolerance);
+    cmd.AddValue("ack_thinning",
+                 "Drop the queued ACKs superseded by a later one at the bottleneck",
+                 conf.ack_thinning);
+    cmd.AddValue("reverse_rate",
+                 "Rate of the UDP cross traffic on the path of the ACKs, empty to disable",
+                 conf.reverse_rate);
+    cmd.AddValue("early_stop",
+                 "Stop the simulation when the throughput and cwnd have converged",
+                 conf.early_stop);
+    cmd.AddValue("convergence_batch",
+                 "Duration of a batch of the convergence monitor (s)",
+                 conf.convergence_batch);
+    cmd.AddValue("convergence_precision",
+                 "Target half width of the 95% CI, relative to the mean",
+                 conf.convergence_precision);
+    cmd.AddValue("min_batches",
+                 "Minimum number of batches after the warm-up to converge",
+                 conf.min_batches);
+    cmd.AddValue("paired_runs",
+                 "Paired replications comparing Tahoe and Reno with the same losses, 0 to disable",
+                 conf.paired_runs);
     cmd.AddValue("prefix_file_name", "Prefix file name", conf.prefix_file_name);
     cmd.AddValue("graph_output", "The type of image to output: png, svg", conf.graph_output);
+    cmd.AddValue("trace_mode",
+                 "When to add a point to the graph: event, sample",
+                 conf.trace_mode);
+    cmd.AddValue("sample_interval", "Time between two samples (s) (sample)", conf.sample_interval);
+    cmd.AddValue("goodput_interval",
+                 "Width of the goodput bins of each flow (s), 0 to disable",
+                 conf.goodput_interval);
+    cmd.AddValue("ack_stats",
+                 "Print the ACK inter-arrival and duplicate ACK statistics of each flow",
+                 conf.ack_stats);
+    cmd.AddValue("metrics_output",
+                 "File or unix:<path> socket to export live metrics to, empty to disable",
+                 conf.metrics_output);
+    cmd.AddValue("metrics_interval",
+                 "Simulated time between two metrics exports (s)",
+                 conf.metrics_interval);
     cmd.AddValue("ascii_tracing", "Enable ASCII tracing", conf.ascii_tracing);
+    cmd.AddValue("event_log", "Enable the binary event log", conf.event_log);
+    cmd.AddValue("event_log_types",
+                 "Comma separated events to log: all, enqueue, dequeue, drop, receive",
+                 conf.event_log_types);
+    cmd.AddValue("event_log_nodes",
+                 "Comma separated ids of the nodes to log, all for every node",
+                 conf.event_log_nodes);
+    cmd.AddValue("memory_accounting",
+                 "Print the memory used by each component of the simulation",
+                 conf.memory_accounting);
+    cmd.AddValue("memory_interval",
+                 "Simulated time between two memory measurements (s)",
+                 conf.memory_interval);
+    cmd.AddValue("memory_budget_mb",
+                 "Stop the simulation when the resident memory exceeds it (MB), 0 to disable",
+                 conf.memory_budget_mb);
+    cmd.AddValue("flight_recorder", "Enable the flight recorder", conf.flight_recorder);
+    cmd.AddValue("flight_recorder_size",
+                 "Events kept for each flow by the flight recorder",
+                 conf.flight_recorder_size);
+    cmd.AddValue("flight_recorder_triggers",
+                 "Comma separated events dumping the flight recorder: rto, recovery, collapse",
+                 conf.flight_recorder_triggers);
     cmd.AddValue("pcap_tracing", "Enable Pcap tracing", conf.pcap_tracing);
+    cmd.AddValue("pcap_devices",
+                 "Devices to capture: all, bottleneck, senders or comma separated node ids",
+                 conf.pcap_devices);
+    cmd.AddValue("pcap_snaplen",
+                 "Bytes captured of each packet, 0 for all (96 keeps the TCP/IP headers)",
+                 conf.pcap_snaplen);
+    cmd.AddValue("pcap_rotate_bytes",
+                 "Start a new Pcap file after this many bytes, 0 to disable",
+                 conf.pcap_rotate_bytes);
+    cmd.AddValue("pcap_rotate_time",
+                 "Start a new Pcap file after this many seconds, 0 to disable",
+                 conf.pcap_rotate_time);
+    cmd.AddValue("pcap_mode", "Packets to capture: full, loss", conf.pcap_mode);
+    cmd.AddValue("pcap_loss_window",
+                 "Packets kept before and after each drop (loss)",
+                 conf.pcap_loss_window);
     cmd.Parse(argc, argv);
 
-    conf.adu_bytes = GetTcpSegmentSize(conf);
+    ResolveConfiguration(conf);
 
     NS_LOG_INFO(conf);
 }
 
+void
+ResolveConfiguration(Configuration& conf)
+{
+    conf.adu_bytes = GetTcpSegmentSize(conf);
+
+    conf.variant_groups.clear();
+    if (conf.variant_mix.empty())
+    {
+        if (conf.n_tcp_tahoe > 0)
+            conf.variant_groups.emplace_back("tahoe", conf.n_tcp_tahoe);
+        if (conf.n_tcp_reno > 0)
+            conf.variant_groups.emplace_back("reno", conf.n_tcp_reno);
+        return;
+    }
+    // Mix of variants: <variant>:<count>,...
+    std::istringstream mix(conf.variant_mix);
+    std::string entry;
+    while (std::getline(mix, entry, ','))
+    {
+        std::size_t separator = entry.find(':');
+        NS_ABORT_MSG_IF(separator == std::string::npos, "Invalid variant mix entry " << entry);
+        std::string name = entry.substr(0, separator);
+        GetTcpVariant(name);
+        // Signed, since an unsigned extraction would wrap a negative count around
+        std::istringstream countStream(entry.substr(separator + 1));
+        int64_t count;
+        char extra;
+        NS_ABORT_MSG_IF(!(countStream >> count) || countStream >> extra || count < 0 ||
+                            count > std::numeric_limits<uint32_t>::max(),
+                        "Invalid number of senders in the variant mix entry " << entry);
+        if (count > 0)
+            conf.variant_groups.emplace_back(name, static_cast<uint32_t>(count));
+    }
+    NS_ABORT_MSG_IF(conf.variant_groups.empty(),
+                    "The variant mix " << conf.variant_mix << " has no senders");
+}
+
 void
 InitializeDefaultConfiguration(const Configuration& conf)
 {
@@ -20,6 +20,10 @@ struct Configuration
      *********************************/
     uint32_t n_tcp_tahoe = 1;          //!< Number of TCP Tahoe nodes.
     uint32_t n_tcp_reno = 1;           //!< Number of TCP Reno nodes.
+    bool swap_variants = false;        //!< Whether the Tahoe nodes use Reno and vice versa.
+    std::string variant_mix = "";      //!< Senders of each variant, "<variant>:<count>,...".
+    std::vector<std::pair<std::string, uint32_t>>
+        variant_groups; //!< Resolved variant_mix, in the order of the senders.
     uint32_t snd_buf_size = 131072;    //!< Send buffer size.
     uint32_t rcv_buf_size = 131072;    //!< Receive buffer size.
     uint32_t initial_cwnd = 1;         //!< Initial congestion window.
@@ -28,30 +32,90 @@ struct Configuration
     uint32_t adu_bytes = 0;            //!< Actual segment size (ADU) in bytes.
     bool sack = true;                  //!< Whether to enable Tcp SACK.
     bool nagle = false;                //!< Whether to disable Nagle's algorithm.
+    uint32_t delack_count = 2;         //!< Segments received before sending a delayed ACK.
+    double delack_timeout = 0.2;       //!< Timeout of the delayed ACKs (s).
     /*********************************
      *Channel Configuration.
      *********************************/
-    double error_p = 0.0;               //!< Error rate of the channel.
-    std::string s_bandwidth = "10Mbps"; //!< Bandwidth of the channel of the sender.
-    std::string s_delay = "40ms";       //!< Delay of the channel of the sender.
-    std::string r_bandwidth = "10Mbps"; //!< Bandwidth of the channel of the receiver.
-    std::string r_delay = "40ms";       //!< Delay of the channel of the receiver.
-    uint32_t tcp_queue_size = 25;       //!< Size of the queue at the TCP level.
+    double error_p = 0.0;                 //!< Error rate of the channel.
+    std::string s_bandwidth = "10Mbps";   //!< Bandwidth of the channel of the sender.
+    std::string s_delay = "40ms";         //!< Delay of the channel of the sender.
+    std::string r_bandwidth = "10Mbps";   //!< Bandwidth of the channel of the receiver.
+    std::string r_delay = "40ms";         //!< Delay of the channel of the receiver.
+    uint32_t n_receivers = 1;             //!< Receiver nodes the flows are spread across.
+    uint32_t sink_ports = 1;              //!< Ports with a sink on each receiver node.
+    uint32_t tcp_queue_size = 25;         //!< Size of the queue at the TCP level.
+    std::string error_model = "rate";     //!< Loss model: rate, gilbert-elliott or trace.
+    std::string error_links = "receiver"; //!< Links with the loss model: receiver, senders, all.
+    double ge_p_good_bad = 0.01;          //!< Gilbert-Elliott good to bad state probability.
+    double ge_p_bad_good = 0.3;           //!< Gilbert-Elliott bad to good state probability.
+    double ge_loss_good = 0.0;            //!< Gilbert-Elliott loss probability in the good state.
+    double ge_loss_bad = 1.0;             //!< Gilbert-Elliott loss probability in the bad state.
+    std::string error_trace = "";         //!< File with the loss trace, a 0 or 1 for each packet.
+    bool error_trace_loop = false;        //!< Whether the loss trace starts over when it ends.
+    std::string link_schedule = "";       //!< Receiver link changes, "<t>:<rate>[:<delay>],...".
+    std::string link_trace = "";          //!< File with the receiver link changes, "<t> <rate>".
+    double reconvergence_window = 0.1;    //!< Window of the reconvergence measurement (s).
+    double reconvergence_tolerance = 0.1; //!< Relative distance from the capacity to reconverge.
+    bool ack_thinning = false;            //!< Whether to thin the ACKs queued at the bottleneck.
+    std::string reverse_rate = "";        //!< Rate of the reverse cross traffic. Empty: off.
     // https://groups.google.com/g/ns-3-users/c/e15_YvL-7v0
     // uint32_t device_queue_size = 100;
+    /*********************************
+     * Workload Configuration.
+     *********************************/
+    std::string workload = "bulk";         //!< Traffic of the senders. Can be "bulk" or "poisson".
+    double flow_arrival_rate = 10.0;       //!< Mean number of new flows per second on each sender.
+    std::string flow_size_dist = "pareto"; //!< Flow size distribution: "pareto" or "empirical".
+    uint64_t flow_size_mean = 100000;      //!< Mean size of the flows (pareto) in bytes.
+    double flow_size_shape = 1.2;          //!< Shape of the pareto flow size distribution.
+    std::string flow_size_cdf = "";        //!< File with the empirical CDF, "<bytes> <cdf>" lines.
+    bool connection_reuse = true;          //!< Whether new flows can reuse idle connections.
+    uint32_t max_connections = 16;         //!< Maximum number of connections of each sender.
     /*********************************
      * Simulation Configuration.
      *********************************/
     uint32_t run = 0;                //!< Run identifier. Used to seed the random number generator.
-    double duration = 3.0;           //!< Duration of the simulation in seconds.
+    double duration = 3.0;           //!< Duration of the simulation in seconds. 0: until done.
     uint64_t max_mbytes_to_send = 0; //!< Maximum number of megabytes to send. 0 means unlimited.
+    double max_duration = 3600.0;    //!< Bound of a simulation without a duration (s).
+    std::string start_schedule = "none"; //!< Start of the senders: none, stagger, jitter, trace.
+    double start_stagger = 0.1;          //!< Time between the start of two senders (s).
+    double start_jitter = 1.0;           //!< Maximum random delay of the start of a sender (s).
+    std::string start_trace = "";        //!< File with the start time of each sender (s).
+    uint32_t paired_runs = 0;            //!< Paired replications to compare the variants. 0: off.
+    bool early_stop = false;             //!< Whether to stop when the metrics have converged.
+    double convergence_batch = 0.5;      //!< Duration of a batch of the convergence monitor (s).
+    double convergence_precision = 0.05; //!< Target relative half width of the 95% CI.
+    uint32_t min_batches = 10;           //!< Minimum batches after the warm-up to converge.
     /*********************************
      * Tracing Configuration.
      *********************************/
     std::string prefix_file_name = "P2P-project"; //!< Prefix of the output trace file.
     std::string graph_output = "png"; //!< Output format of the graph. Can be "png" or "svg".
+    std::string trace_mode = "event"; //!< When to add graph points. Can be "event" or "sample".
+    double sample_interval = 0.01;    //!< Time between two samples in "sample" mode (s).
+    double goodput_interval = 0;      //!< Width of the goodput bins of each flow (s). 0: off.
+    bool ack_stats = false;           //!< Enable or disable the ACK statistics of each flow.
+    std::string metrics_output = "";  //!< File or "unix:<path>" socket for the live metrics.
+    double metrics_interval = 1.0;    //!< Simulated time between two metrics exports (s).
     bool pcap_tracing = false;        //!< Enable or disable PCAP tracing.
+    std::string pcap_devices = "all"; //!< Devices to capture: all, bottleneck, senders, node ids.
+    uint32_t pcap_snaplen = 0;        //!< Bytes captured of each packet. 0 means all.
+    uint64_t pcap_rotate_bytes = 0;   //!< Size after which a new PCAP file is used. 0 means never.
+    double pcap_rotate_time = 0;      //!< Time after which a new PCAP file is used (s). 0: never.
+    std::string pcap_mode = "full";   //!< Packets to capture. Can be "full" or "loss".
+    uint32_t pcap_loss_window = 32;   //!< Packets kept before and after each drop in "loss" mode.
     bool ascii_tracing = false;       //!< Enable or disable ASCII tracing.
+    bool event_log = false;           //!< Enable or disable the binary event log.
+    std::string event_log_types = "all"; //!< Events to log: enqueue, dequeue, drop, receive.
+    std::string event_log_nodes = "all"; //!< Comma separated ids of the nodes to log.
+    bool memory_accounting = false;      //!< Enable or disable the memory report.
+    double memory_interval = 1.0;        //!< Simulated time between two memory measurements (s).
+    uint32_t memory_budget_mb = 0;       //!< Resident memory that stops the run (MB). 0: no limit.
+    bool flight_recorder = false;        //!< Enable or disable the flight recorder.
+    uint32_t flight_recorder_size = 1024; //!< Events kept for each flow by the flight recorder.
+    std::string flight_recorder_triggers = "rto,recovery,collapse"; //!< Triggers of the dumps.
 };
 
 /**
@@ -62,6 +126,41 @@ struct Configuration
  */
 std::ostream& operator<<(std::ostream& os, const Configuration& conf);
 
+/**
+ * @brief TCP variant a sender can use, as a congestion control and a recovery algorithm.
+ */
+struct TcpVariant
+{
+    std::string name;          //!< Name used in the variant_mix, e.g. "cubic".
+    TypeId (*congestionOps)(); //!< TypeId getter of the congestion control.
+    TypeId (*recoveryOps)();   //!< TypeId getter of the recovery algorithm.
+    bool pacing = false;       //!< Whether the sockets pace at the rate set by the variant.
+};
+
+/**
+ * @brief Get a TCP variant by name.
+ * The supported variants are tahoe, reno, newreno, cubic and bbr. Aborts if the name is unknown.
+ * @param name Name of the variant.
+ * @return TCP variant.
+ */
+const TcpVariant& GetTcpVariant(const std::string& name);
+
+/**
+ * @brief Get the number of flows, one for each sender node.
+ * @param conf Configuration.
+ * @return Number of flows.
+ */
+uint32_t GetFlowCount(const Configuration& conf);
+/**
+ * @brief Get the name of the TCP variant used by a flow.
+ * The senders are assigned to the variant_groups in order. With swap_variants, the Tahoe senders
+ * use Reno and vice versa.
+ * @param conf Configuration.
+ * @param flow Index of the flow, which is also the id of its sender node.
+ * @return Name of the TCP variant.
+ */
+std::string GetFlowVariant(const Configuration& conf, uint32_t flow);
+
 /**
  * @brief Parse the command line arguments and store them in the configuration.
  * @param conf Configuration object to store the values in.
@@ -69,6 +168,14 @@ std::ostream& operator<<(std::ostream& os, const Configuration& conf);
  * @param argv Arguments.
  */
 void ParseConsoleArgs(Configuration& conf, int argc, char* argv[]);
+/**
+ * @brief Compute the values of the configuration derived from the other ones, like adu_bytes and
+ * the variant_groups, which come from n_tcp_tahoe and n_tcp_reno if variant_mix is empty.
+ * Already called by ParseConsoleArgs. It must be called on a configuration built in code before
+ * using it.
+ * @param conf Configuration to resolve.
+ */
+void ResolveConfiguration(Configuration& conf);
 /**
  * @brief Initialize the default attributes of the simulation with the configuration.
  * @param configuration Configuration.
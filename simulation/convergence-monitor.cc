@@ -0,0 +1,176 @@
+#include "convergence-monitor.h"
+
+#include "statistics.h"
+
+#include <cmath>
+#include <limits>
+#include <set>
+
+NS_LOG_COMPONENT_DEFINE("ConvergenceMonitor");
+
+/// Observations grouped in a batch, as in MSER-5
+static const uint32_t OBSERVATIONS_PER_BATCH = 5;
+
+ConvergenceMonitor::ConvergenceMonitor(const Configuration& conf, const Tracer& tracer)
+    : m_conf(conf),
+      m_tracer(tracer),
+      m_nObservations(0),
+      m_stopTime(-1)
+{
+}
+
+void
+ConvergenceMonitor::Start()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_conf.early_stop)
+        return;
+    NS_ABORT_MSG_IF(m_conf.convergence_batch <= 0, "The convergence batch must be positive");
+    NS_ABORT_MSG_IF(m_conf.min_batches < 2, "At least 2 batches are needed to converge");
+
+    std::set<std::string> variants;
+    for (uint32_t flow = 0; flow < GetFlowCount(m_conf); flow++)
+        variants.insert(GetFlowVariant(m_conf, flow));
+    for (const std::string& variant : variants)
+    {
+        m_metrics.push_back({"throughput " + variant, variant, true});
+        // The cwnd is not tracked by the policies that do not record the state of the flows
+        if constexpr (TracingPolicy::recordState)
+            m_metrics.push_back({"cwnd " + variant, variant, false});
+        m_lastRxBytes[variant] = 0;
+    }
+    Simulator::Schedule(Seconds(m_conf.convergence_batch / OBSERVATIONS_PER_BATCH),
+                        &ConvergenceMonitor::Observe,
+                        this);
+}
+
+void
+ConvergenceMonitor::Observe()
+{
+    NS_LOG_FUNCTION(this);
+
+    const double interval = m_conf.convergence_batch / OBSERVATIONS_PER_BATCH;
+    std::map<std::string, uint64_t> rxBytes;
+    std::map<std::string, double> cwnd;
+    std::map<std::string, uint32_t> nFlows;
+    const std::map<uint32_t, FlowStats>& flowStats = m_tracer.GetFlowStats();
+    for (uint32_t flow = 0; flow < GetFlowCount(m_conf); flow++)
+    {
+        std::string variant = GetFlowVariant(m_conf, flow);
+        auto stats = flowStats.find(flow);
+        rxBytes[variant] += stats == flowStats.end() ? 0 : stats->second.rxBytes;
+        cwnd[variant] += static_cast<double>(m_tracer.GetCurrentCwnd(flow)) / m_conf.adu_bytes;
+        nFlows[variant]++;
+    }
+
+    for (ConvergenceMetric& metric : m_metrics)
+    {
+        if (metric.throughput)
+            metric.batchSum +=
+                (rxBytes[metric.variant] - m_lastRxBytes[metric.variant]) * 8 / interval / 1e6;
+        else
+            metric.batchSum += cwnd[metric.variant] / nFlows[metric.variant];
+    }
+    m_lastRxBytes = rxBytes;
+
+    if (++m_nObservations == OBSERVATIONS_PER_BATCH)
+    {
+        m_nObservations = 0;
+        bool converged = true;
+        for (ConvergenceMetric& metric : m_metrics)
+        {
+            metric.batchMeans.push_back(metric.batchSum / OBSERVATIONS_PER_BATCH);
+            metric.batchSum = 0;
+            // Every estimate is updated, so that the results are complete when stopping
+            converged = UpdateEstimate(metric) && converged;
+        }
+        if (converged)
+        {
+            m_stopTime = Simulator::Now().GetSeconds();
+            NS_LOG_INFO("Metrics converged at " << m_stopTime << " s");
+            Simulator::Stop();
+            return;
+        }
+    }
+    Simulator::Schedule(Seconds(interval), &ConvergenceMonitor::Observe, this);
+}
+
+bool
+ConvergenceMonitor::UpdateEstimate(ConvergenceMetric& metric) const
+{
+    const std::vector<double>& batches = metric.batchMeans;
+    const std::size_t n = batches.size();
+
+    // MSER: the cutoff d minimizes the variance of the remaining batches divided by their number,
+    // only considering the first half of the batches. Suffix sums make each candidate O(1).
+    double sum = 0, sumSquares = 0, bestMser = std::numeric_limits<double>::infinity();
+    std::size_t bestCutoff = 0;
+    for (std::size_t d = n; d-- > 0;)
+    {
+        sum += batches[d];
+        sumSquares += batches[d] * batches[d];
+        if (d > n / 2)
+            continue;
+        std::size_t k = n - d;
+        double mean = sum / k;
+        double mser = (sumSquares / k - mean * mean) / k;
+        if (mser <= bestMser)
+        {
+            bestMser = mser;
+            bestCutoff = d;
+        }
+    }
+
+    metric.warmupBatches = bestCutoff;
+    std::vector<double> steadyBatches(batches.begin() + bestCutoff, batches.end());
+    metric.halfWidth = ConfidenceHalfWidth95(steadyBatches, metric.mean);
+    return steadyBatches.size() >= m_conf.min_batches &&
+           metric.halfWidth <= m_conf.convergence_precision * std::abs(metric.mean);
+}
+
+bool
+ConvergenceMonitor::HasConverged() const
+{
+    return m_stopTime >= 0;
+}
+
+double
+ConvergenceMonitor::GetWarmupTime() const
+{
+    std::size_t warmupBatches = 0;
+    for (const ConvergenceMetric& metric : m_metrics)
+        warmupBatches = std::max(warmupBatches, metric.warmupBatches);
+    return warmupBatches * m_conf.convergence_batch;
+}
+
+double
+ConvergenceMonitor::GetStopTime() const
+{
+    return m_stopTime;
+}
+
+const std::vector<ConvergenceMetric>&
+ConvergenceMonitor::GetMetrics() const
+{
+    return m_metrics;
+}
+
+void
+ConvergenceMonitor::PrintResults() const
+{
+    std::cout << "========== Convergence ==========" << std::endl;
+    if (HasConverged())
+        std::cout << "Converged at (s): " << m_stopTime;
+    else
+        std::cout << "Not converged by (s): " << Simulator::Now().GetSeconds();
+    std::cout << "\tWarm-up cutoff (s): " << GetWarmupTime() << std::endl;
+    for (const ConvergenceMetric& metric : m_metrics)
+    {
+        std::cout << metric.name << ": " << metric.mean << " +- " << metric.halfWidth
+                  << " (95% CI, " << metric.batchMeans.size() - metric.warmupBatches
+                  << " batches after " << metric.warmupBatches * m_conf.convergence_batch
+                  << " s of warm-up)" << std::endl;
+    }
+    std::cout << "=================================" << std::endl;
+}
@@ -0,0 +1,100 @@
+#ifndef P2P_SIMULATION_CONVERGENCE_MONITOR_H
+#define P2P_SIMULATION_CONVERGENCE_MONITOR_H
+
+#include "configuration.h"
+#include "tracer.h"
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/**
+ * @brief Metric whose convergence is monitored.
+ */
+struct ConvergenceMetric
+{
+    std::string name;               //!< Name of the metric, e.g. "throughput tahoe".
+    std::string variant;            //!< TCP variant the metric is computed on.
+    bool throughput;                //!< True for the throughput, false for the cwnd.
+    double batchSum = 0;            //!< Sum of the observations of the current batch.
+    std::vector<double> batchMeans; //!< Mean of each completed batch.
+    std::size_t warmupBatches = 0;  //!< Batches removed as warm-up by MSER-5.
+    double mean = 0;                //!< Mean of the batches after the warm-up.
+    double halfWidth = 0;           //!< Half width of the 95% confidence interval of the mean.
+};
+
+/**
+ * @brief ConvergenceMonitor class.
+ * It stops the simulation as soon as the per-variant throughput and cwnd time averages have
+ * converged, instead of always running for the whole duration.
+ * Each metric is observed OBSERVATIONS_PER_BATCH times per convergence_batch, and the
+ * observations are grouped in batches. The warm-up is removed with MSER-5, i.e. choosing the
+ * number of initial batches that minimizes the standard error of the remaining ones, and the
+ * confidence interval is computed with the method of batch means.
+ * The simulation stops when, for every metric, there are at least min_batches batches after the
+ * warm-up and the half width of the 95% confidence interval is within convergence_precision
+ * times the mean.
+ */
+class ConvergenceMonitor
+{
+  public:
+    /**
+     * @brief ConvergenceMonitor constructor.
+     * @param conf simulation configuration.
+     * @param tracer tracer the metrics are read from.
+     */
+    ConvergenceMonitor(const Configuration& conf, const Tracer& tracer);
+
+    /**
+     * @brief Schedule the first observation, if early_stop is enabled.
+     */
+    void Start();
+    /**
+     * @brief Observe all the metrics and schedule the next observation.
+     * Stops the simulation if all the metrics have converged.
+     */
+    void Observe();
+    /**
+     * @brief Check if the simulation was stopped because the metrics converged.
+     * @return true if the metrics converged.
+     */
+    bool HasConverged() const;
+    /**
+     * @brief Warm-up cutoff getter.
+     * @return end of the longest warm-up among the metrics (s).
+     */
+    double GetWarmupTime() const;
+    /**
+     * @brief Stop time getter.
+     * @return time the metrics converged (s), -1 if they did not.
+     */
+    double GetStopTime() const;
+    /**
+     * @brief Monitored metrics getter.
+     * @return monitored metrics.
+     */
+    const std::vector<ConvergenceMetric>& GetMetrics() const;
+    /**
+     * @brief Print the warm-up cutoff, the stop time and the estimate of each metric to the
+     * console.
+     */
+    void PrintResults() const;
+
+  private:
+    /**
+     * @brief Update the warm-up and the confidence interval of a metric.
+     * @param metric metric to update.
+     * @return true if the metric has converged.
+     */
+    bool UpdateEstimate(ConvergenceMetric& metric) const;
+
+  private:
+    const Configuration& m_conf;                   //!< Configuration
+    const Tracer& m_tracer;                        //!< Tracer the metrics are read from
+    std::vector<ConvergenceMetric> m_metrics;      //!< Monitored metrics
+    std::map<std::string, uint64_t> m_lastRxBytes; //!< Bytes received by each variant
+    uint32_t m_nObservations;                      //!< Observations of the current batch
+    double m_stopTime;                             //!< Time the metrics converged (s)
+};
+
+#endif /* P2P_SIMULATION_CONVERGENCE_MONITOR_H */
@@ -0,0 +1,200 @@
+#include "error-models.h"
+
+#include <fstream>
+
+NS_LOG_COMPONENT_DEFINE("ErrorModels");
+NS_OBJECT_ENSURE_REGISTERED(GilbertElliottErrorModel);
+NS_OBJECT_ENSURE_REGISTERED(TraceErrorModel);
+NS_OBJECT_ENSURE_REGISTERED(RecordingErrorModel);
+
+TypeId
+GilbertElliottErrorModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::GilbertElliottErrorModel")
+                            .SetParent<ErrorModel>()
+                            .SetGroupName("Network")
+                            .AddConstructor<GilbertElliottErrorModel>();
+    return tid;
+}
+
+GilbertElliottErrorModel::GilbertElliottErrorModel()
+    : m_bad(false),
+      m_pGoodBad(0),
+      m_pBadGood(1),
+      m_lossGood(0),
+      m_lossBad(1),
+      m_ranvar(CreateObject<UniformRandomVariable>())
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+GilbertElliottErrorModel::SetTransitionProbabilities(double pGoodBad, double pBadGood)
+{
+    NS_LOG_FUNCTION(this << pGoodBad << pBadGood);
+    m_pGoodBad = pGoodBad;
+    m_pBadGood = pBadGood;
+}
+
+void
+GilbertElliottErrorModel::SetLossProbabilities(double lossGood, double lossBad)
+{
+    NS_LOG_FUNCTION(this << lossGood << lossBad);
+    m_lossGood = lossGood;
+    m_lossBad = lossBad;
+}
+
+void
+GilbertElliottErrorModel::SetRandomVariable(Ptr<RandomVariableStream> ranvar)
+{
+    NS_LOG_FUNCTION(this << ranvar);
+    m_ranvar = ranvar;
+}
+
+bool
+GilbertElliottErrorModel::DoCorrupt(Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+
+    if (m_ranvar->GetValue() < (m_bad ? m_pBadGood : m_pGoodBad))
+        m_bad = !m_bad;
+    return m_ranvar->GetValue() < (m_bad ? m_lossBad : m_lossGood);
+}
+
+void
+GilbertElliottErrorModel::DoReset()
+{
+    NS_LOG_FUNCTION(this);
+    m_bad = false;
+}
+
+TypeId
+TraceErrorModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TraceErrorModel")
+                            .SetParent<ErrorModel>()
+                            .SetGroupName("Network")
+                            .AddConstructor<TraceErrorModel>();
+    return tid;
+}
+
+TraceErrorModel::TraceErrorModel()
+    : m_next(0),
+      m_loop(false),
+      m_overflow(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+std::shared_ptr<const std::vector<bool>>
+TraceErrorModel::LoadTrace(const std::string& fileName)
+{
+    std::ifstream traceFile(fileName);
+    NS_ABORT_MSG_IF(!traceFile.is_open(), "Cannot open the loss trace " << fileName);
+
+    auto trace = std::make_shared<std::vector<bool>>();
+    int lost;
+    while (traceFile >> lost)
+    {
+        NS_ABORT_MSG_IF(lost != 0 && lost != 1, "The loss trace must only contain 0 and 1");
+        trace->push_back(lost == 1);
+    }
+    NS_ABORT_MSG_IF(!traceFile.eof(), "The loss trace must only contain 0 and 1");
+    return trace;
+}
+
+void
+TraceErrorModel::SetTrace(std::shared_ptr<const std::vector<bool>> trace)
+{
+    NS_LOG_FUNCTION(this);
+    m_trace = trace;
+    m_next = 0;
+}
+
+void
+TraceErrorModel::SetLoop(bool loop)
+{
+    NS_LOG_FUNCTION(this << loop);
+    m_loop = loop;
+}
+
+void
+TraceErrorModel::SetFallback(Ptr<ErrorModel> fallback)
+{
+    NS_LOG_FUNCTION(this << fallback);
+    m_fallback = fallback;
+}
+
+uint64_t
+TraceErrorModel::GetOverflow() const
+{
+    return m_overflow;
+}
+
+bool
+TraceErrorModel::DoCorrupt(Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+
+    if (!m_trace || m_trace->empty())
+        return false;
+    if (m_next == m_trace->size() && m_loop)
+        m_next = 0;
+    if (m_next < m_trace->size())
+        return (*m_trace)[m_next++];
+
+    // Starting over would apply the first losses again to packets they were not recorded for
+    if (m_overflow++ == 0)
+        NS_LOG_WARN("Loss trace of " << m_trace->size() << " packets exhausted");
+    return m_fallback && m_fallback->IsCorrupt(p);
+}
+
+void
+TraceErrorModel::DoReset()
+{
+    NS_LOG_FUNCTION(this);
+    m_next = 0;
+    m_overflow = 0;
+    if (m_fallback)
+        m_fallback->Reset();
+}
+
+TypeId
+RecordingErrorModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::RecordingErrorModel")
+                            .SetParent<ErrorModel>()
+                            .SetGroupName("Network")
+                            .AddConstructor<RecordingErrorModel>();
+    return tid;
+}
+
+RecordingErrorModel::RecordingErrorModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+RecordingErrorModel::Setup(Ptr<ErrorModel> errorModel, std::shared_ptr<std::vector<bool>> record)
+{
+    NS_LOG_FUNCTION(this << errorModel);
+    m_errorModel = errorModel;
+    m_record = record;
+}
+
+bool
+RecordingErrorModel::DoCorrupt(Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+
+    bool lost = m_errorModel->IsCorrupt(p);
+    m_record->push_back(lost);
+    return lost;
+}
+
+void
+RecordingErrorModel::DoReset()
+{
+    NS_LOG_FUNCTION(this);
+    m_errorModel->Reset();
+}
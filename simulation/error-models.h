@@ -0,0 +1,174 @@
+#ifndef P2P_SIMULATION_ERROR_MODELS_H
+#define P2P_SIMULATION_ERROR_MODELS_H
+
+#include "ns3/core-module.h"
+#include "ns3/error-model.h"
+
+#include <memory>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @brief GilbertElliottErrorModel class.
+ * Two state Markov chain loss model, used to reproduce the losses in bursts of real links.
+ * The link is either in the good or in the bad state, each with its own loss probability.
+ * Before each packet, the link moves from the good to the bad state with probability p_good_bad
+ * and from the bad to the good state with probability p_bad_good, so the mean length of a burst
+ * is 1 / p_bad_good packets.
+ */
+class GilbertElliottErrorModel : public ErrorModel
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * @brief GilbertElliottErrorModel constructor.
+     * It starts in the good state.
+     */
+    GilbertElliottErrorModel();
+
+    /**
+     * @brief Set the probabilities of moving from a state to the other.
+     * @param pGoodBad probability of moving from the good to the bad state.
+     * @param pBadGood probability of moving from the bad to the good state.
+     */
+    void SetTransitionProbabilities(double pGoodBad, double pBadGood);
+    /**
+     * @brief Set the probability of losing a packet in each state.
+     * @param lossGood loss probability in the good state.
+     * @param lossBad loss probability in the bad state.
+     */
+    void SetLossProbabilities(double lossGood, double lossBad);
+    /**
+     * @brief Set the random variable used to draw the transitions and the losses.
+     * @param ranvar uniform random variable in [0, 1).
+     */
+    void SetRandomVariable(Ptr<RandomVariableStream> ranvar);
+
+  private:
+    bool DoCorrupt(Ptr<Packet> p) override;
+    void DoReset() override;
+
+  private:
+    bool m_bad;                        //!< True if the link is in the bad state.
+    double m_pGoodBad;                 //!< Probability of moving from the good to the bad state.
+    double m_pBadGood;                 //!< Probability of moving from the bad to the good state.
+    double m_lossGood;                 //!< Loss probability in the good state.
+    double m_lossBad;                  //!< Loss probability in the bad state.
+    Ptr<RandomVariableStream> m_ranvar; //!< Random variable.
+};
+
+/**
+ * @brief TraceErrorModel class.
+ * It replays a recorded loss trace: the i-th packet received by the device is lost if the i-th
+ * entry of the trace is 1. Past the end of the trace, the trace starts over if it loops, otherwise
+ * the packets are left to the fallback model, if any, or received, and counted as overflow.
+ */
+class TraceErrorModel : public ErrorModel
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * @brief TraceErrorModel constructor.
+     * Without a trace, no packet is lost.
+     */
+    TraceErrorModel();
+
+    /**
+     * @brief Read a loss trace from a file.
+     * The file contains a 0 (received) or a 1 (lost) for each packet, separated by whitespaces.
+     * @param fileName path of the trace file.
+     * @return loss trace, which can be shared by multiple models.
+     */
+    static std::shared_ptr<const std::vector<bool>> LoadTrace(const std::string& fileName);
+    /**
+     * @brief Set the loss trace to replay.
+     * @param trace loss trace.
+     */
+    void SetTrace(std::shared_ptr<const std::vector<bool>> trace);
+    /**
+     * @brief Set whether the trace starts over when all its entries have been used.
+     * @param loop true to start over, false to use the fallback model past the end.
+     */
+    void SetLoop(bool loop);
+    /**
+     * @brief Set the model deciding the losses past the end of the trace, when it does not loop.
+     * @param fallback loss model, or nullptr to receive every packet past the end.
+     */
+    void SetFallback(Ptr<ErrorModel> fallback);
+    /**
+     * @brief Get the number of packets received past the end of the trace, when it does not loop.
+     * @return packets not covered by the trace.
+     */
+    uint64_t GetOverflow() const;
+
+  private:
+    bool DoCorrupt(Ptr<Packet> p) override;
+    void DoReset() override;
+
+  private:
+    std::shared_ptr<const std::vector<bool>> m_trace; //!< Loss trace.
+    std::size_t m_next;                                //!< Index of the next entry of the trace.
+    bool m_loop;                                       //!< Whether the trace starts over.
+    Ptr<ErrorModel> m_fallback;                        //!< Loss model past the end of the trace.
+    uint64_t m_overflow;                               //!< Packets past the end of the trace.
+};
+
+/**
+ * @brief RecordingErrorModel class.
+ * It wraps another loss model and records each of its decisions, so that a later run can replay
+ * exactly the same losses with a TraceErrorModel.
+ */
+class RecordingErrorModel : public ErrorModel
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * @brief RecordingErrorModel constructor.
+     */
+    RecordingErrorModel();
+
+    /**
+     * @brief Set the wrapped model and where to record its decisions.
+     * @param errorModel loss model taking the decisions.
+     * @param record loss trace the decisions are appended to.
+     */
+    void Setup(Ptr<ErrorModel> errorModel, std::shared_ptr<std::vector<bool>> record);
+
+  private:
+    bool DoCorrupt(Ptr<Packet> p) override;
+    void DoReset() override;
+
+  private:
+    Ptr<ErrorModel> m_errorModel;                //!< Wrapped loss model.
+    std::shared_ptr<std::vector<bool>> m_record; //!< Recorded decisions.
+};
+
+/**
+ * @brief Loss decisions of all the devices of a run, used to give two runs the same losses.
+ * The traces are stored in the order the loss models are installed, which is the same in every
+ * run with the same topology.
+ */
+struct LossRecording
+{
+    std::vector<std::shared_ptr<std::vector<bool>>> devices; //!< Loss trace of each device.
+    bool replay = false; //!< False to record the losses, true to replay them.
+    uint64_t overflow = 0; //!< Packets of the replay past the end of the recorded traces.
+};
+
+#endif /* P2P_SIMULATION_ERROR_MODELS_H */
@@ -0,0 +1,52 @@
+#ifndef P2P_SIMULATION_EVENT_LOG_RECORD_H
+#define P2P_SIMULATION_EVENT_LOG_RECORD_H
+
+#include <cstdint>
+
+/**
+ * @brief Type of an event in the binary event log.
+ * Each type matches one of the lines of the ASCII tracing of a point-to-point device.
+ */
+enum class EventLogType : uint8_t
+{
+    Enqueue = 0, //!< Packet enqueued in the device queue ('+').
+    Dequeue = 1, //!< Packet dequeued from the device queue ('-').
+    Drop = 2,    //!< Packet dropped by the device queue ('d').
+    Receive = 3, //!< Packet received by the device ('r').
+    RxDrop = 4,  //!< Packet dropped by the error model of the device ('d').
+    NumTypes = 5
+};
+
+/**
+ * @brief Header at the beginning of a binary event log file.
+ * Both header and records are stored with the byte order of the machine that wrote them.
+ */
+struct EventLogFileHeader
+{
+    char magic[8];       //!< Always "P2PEVLOG".
+    uint32_t version;    //!< Version of the format.
+    uint32_t recordSize; //!< Size of each record in bytes.
+};
+
+/**
+ * @brief Fixed-size record of a single event in the binary event log.
+ */
+struct EventLogRecord
+{
+    uint64_t time;   //!< Time of the event (ns).
+    uint32_t seq;    //!< TCP sequence number, 0 if the packet is not a TCP segment.
+    uint32_t size;   //!< Size of the packet (bytes).
+    uint32_t node;   //!< Id of the node.
+    uint16_t device; //!< Index of the device in the node.
+    uint8_t type;    //!< EventLogType of the event.
+    uint8_t flags;   //!< TCP flags, 0 if the packet is not a TCP segment.
+};
+
+static_assert(sizeof(EventLogRecord) == 24, "EventLogRecord must not be padded");
+
+/// Magic string at the beginning of a binary event log file
+static constexpr char EVENT_LOG_MAGIC[8] = {'P', '2', 'P', 'E', 'V', 'L', 'O', 'G'};
+/// Version of the binary event log format
+static constexpr uint32_t EVENT_LOG_VERSION = 1;
+
+#endif /* P2P_SIMULATION_EVENT_LOG_RECORD_H */
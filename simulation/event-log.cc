@@ -0,0 +1,142 @@
+#include "event-log.h"
+
+#include "ns3/ipv4-header.h"
+#include "ns3/ppp-header.h"
+#include "ns3/tcp-header.h"
+
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("EventLog");
+
+/// Number of records buffered before being written to the file
+static const std::size_t EVENT_LOG_BUFFER_SIZE = 4096;
+
+EventLog::EventLog(const Configuration& conf)
+    : m_conf(conf),
+      m_typeMask(0)
+{
+    static const std::map<std::string, std::vector<EventLogType>> typeNames = {
+        {"enqueue", {EventLogType::Enqueue}},
+        {"dequeue", {EventLogType::Dequeue}},
+        {"drop", {EventLogType::Drop, EventLogType::RxDrop}},
+        {"receive", {EventLogType::Receive}}};
+
+    std::istringstream types(conf.event_log_types);
+    std::string type;
+    while (std::getline(types, type, ','))
+    {
+        if (type == "all")
+        {
+            m_typeMask = (1 << static_cast<uint32_t>(EventLogType::NumTypes)) - 1;
+            continue;
+        }
+        auto it = typeNames.find(type);
+        NS_ABORT_MSG_IF(it == typeNames.end(), "Unknown event log type " << type);
+        for (EventLogType logType : it->second)
+            m_typeMask |= 1 << static_cast<uint32_t>(logType);
+    }
+
+    std::istringstream nodes(conf.event_log_nodes);
+    std::string node;
+    while (std::getline(nodes, node, ','))
+    {
+        if (node != "all")
+            m_nodes.insert(std::stoul(node));
+    }
+    m_buffer.reserve(EVENT_LOG_BUFFER_SIZE);
+}
+
+bool
+EventLog::IsNodeLogged(uint32_t nodeId) const
+{
+    return m_nodes.empty() || m_nodes.count(nodeId) != 0;
+}
+
+void
+EventLog::Install(Ptr<PointToPointNetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+
+    if (!m_file.is_open())
+    {
+        m_file.open(m_conf.prefix_file_name + ".evl", std::ios::out | std::ios::binary);
+        NS_ABORT_MSG_IF(!m_file.is_open(), "Cannot open the event log file");
+        EventLogFileHeader header = {};
+        std::copy(std::begin(EVENT_LOG_MAGIC), std::end(EVENT_LOG_MAGIC), header.magic);
+        header.version = EVENT_LOG_VERSION;
+        header.recordSize = sizeof(EventLogRecord);
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    Ptr<Object> queue = device->GetQueue();
+    Connect(device, queue, "Enqueue", EventLogType::Enqueue);
+    Connect(device, queue, "Dequeue", EventLogType::Dequeue);
+    Connect(device, queue, "Drop", EventLogType::Drop);
+    Connect(device, device, "MacRx", EventLogType::Receive);
+    Connect(device, device, "PhyRxDrop", EventLogType::RxDrop);
+}
+
+void
+EventLog::Close()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_file.is_open())
+        return;
+    Flush();
+    m_file.close();
+}
+
+void
+EventLog::PacketTracer(EventLog* log, std::size_t source, Ptr<const Packet> packet)
+{
+    const EventSource& eventSource = log->m_sources[source];
+    EventLogRecord record = {static_cast<uint64_t>(Simulator::Now().GetNanoSeconds()),
+                             0,
+                             packet->GetSize(),
+                             eventSource.node,
+                             eventSource.device,
+                             static_cast<uint8_t>(eventSource.type),
+                             0};
+
+    // All the traced packets still have their PPP header
+    Ptr<Packet> copy = packet->Copy();
+    PppHeader pppHeader;
+    Ipv4Header ipv4Header;
+    TcpHeader tcpHeader;
+    if (copy->RemoveHeader(pppHeader) != 0 && pppHeader.GetProtocol() == 0x0021 &&
+        copy->RemoveHeader(ipv4Header) != 0 && ipv4Header.GetProtocol() == 6 &&
+        ipv4Header.GetFragmentOffset() == 0 && copy->PeekHeader(tcpHeader) != 0)
+    {
+        record.seq = tcpHeader.GetSequenceNumber().GetValue();
+        record.flags = tcpHeader.GetFlags();
+    }
+
+    log->m_buffer.push_back(record);
+    if (log->m_buffer.size() >= EVENT_LOG_BUFFER_SIZE)
+        log->Flush();
+}
+
+void
+EventLog::Connect(Ptr<PointToPointNetDevice> device,
+                  Ptr<Object> object,
+                  std::string name,
+                  EventLogType type)
+{
+    if (!(m_typeMask & (1 << static_cast<uint32_t>(type))))
+        return;
+
+    m_sources.push_back(
+        {device->GetNode()->GetId(), static_cast<uint16_t>(device->GetIfIndex()), type});
+    object->TraceConnectWithoutContext(
+        name,
+        MakeBoundCallback(&EventLog::PacketTracer, this, m_sources.size() - 1));
+}
+
+void
+EventLog::Flush()
+{
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()),
+                 m_buffer.size() * sizeof(EventLogRecord));
+    m_buffer.clear();
+}
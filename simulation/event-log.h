@@ -0,0 +1,93 @@
+#ifndef P2P_SIMULATION_EVENT_LOG_H
+#define P2P_SIMULATION_EVENT_LOG_H
+
+#include "configuration.h"
+#include "event-log-record.h"
+
+#include "ns3/core-module.h"
+#include "ns3/point-to-point-net-device.h"
+
+#include <fstream>
+#include <set>
+
+using namespace ns3;
+
+/**
+ * @brief EventLog class.
+ * Compact replacement of the ASCII tracing.
+ * Each enqueue, dequeue, drop and receive of the traced devices is written to
+ * <prefix_file_name>.evl as a fixed-size EventLogRecord.
+ * Only the event types in event_log_types and the nodes in event_log_nodes are traced, and the
+ * trace sources of the other ones are not even connected.
+ * The tools/event-log-to-ascii converter produces the legacy ASCII format from the log.
+ */
+class EventLog
+{
+  public:
+    /**
+     * @brief EventLog constructor.
+     * @param conf simulation configuration.
+     */
+    EventLog(const Configuration& conf);
+
+    /**
+     * @brief Check if the events of a node are logged.
+     * @param nodeId id of the node.
+     * @return true if the node is in event_log_nodes.
+     */
+    bool IsNodeLogged(uint32_t nodeId) const;
+    /**
+     * @brief Start logging the events of a device.
+     * The log file is opened the first time this method is called.
+     * @param device device to log.
+     */
+    void Install(Ptr<PointToPointNetDevice> device);
+    /**
+     * @brief Write the buffered records and close the log file.
+     */
+    void Close();
+
+  private:
+    /**
+     * @brief Device and event type a trace source is connected for.
+     */
+    struct EventSource
+    {
+        uint32_t node;     //!< Id of the node.
+        uint16_t device;   //!< Index of the device in the node.
+        EventLogType type; //!< Type of the event.
+    };
+
+    /**
+     * @brief Trace a packet event.
+     * @param log event log.
+     * @param source index of the event source.
+     * @param packet packet of the event.
+     */
+    static void PacketTracer(EventLog* log, std::size_t source, Ptr<const Packet> packet);
+    /**
+     * @brief Connect a trace source of the device, if its event type is logged.
+     * @param device device the trace source belongs to.
+     * @param object object the trace source belongs to.
+     * @param name name of the trace source.
+     * @param type type of the event.
+     */
+    void Connect(Ptr<PointToPointNetDevice> device,
+                 Ptr<Object> object,
+                 std::string name,
+                 EventLogType type);
+    /**
+     * @brief Write the buffered records to the log file.
+     */
+    void Flush();
+
+  private:
+    const Configuration& m_conf;           //!< Configuration
+    uint32_t m_typeMask;                   //!< Bit i is set if EventLogType i is logged
+    std::set<uint32_t> m_nodes;            //!< Nodes logged, empty for all
+    std::vector<EventSource> m_sources;    //!< Connected event sources
+    std::vector<EventLogRecord> m_buffer;  //!< Records not written yet
+    std::ofstream m_file;                  //!< Log file
+};
+
+#endif /* P2P_SIMULATION_EVENT_LOG_H */
@@ -0,0 +1,258 @@
+#include "flight-recorder.h"
+
+#include "ns3/ipv4-queue-disc-item.h"
+
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("FlightRecorder");
+
+/// Interval between two throughput collapse checks
+static const Time COLLAPSE_INTERVAL = MilliSeconds(100);
+/// Fraction of the average acknowledged bytes per interval below which the throughput collapsed
+static const double COLLAPSE_RATIO = 0.1;
+/// Fraction of the average acknowledged bytes per interval above which the throughput recovered
+static const double RECOVERY_RATIO = 0.5;
+/// Maximum number of dumps written for each flow
+static const uint32_t MAX_DUMPS_PER_FLOW = 16;
+
+FlightRecorder::FlightRecorder(const Configuration& conf)
+    : m_conf(conf),
+      m_mask(0),
+      m_collapseScheduled(false)
+{
+    // The size of the ring buffers is rounded up to a power of two, so the index is a mask away
+    uint32_t size = 1;
+    while (size < conf.flight_recorder_size)
+        size <<= 1;
+    m_mask = size - 1;
+
+    std::istringstream triggers(conf.flight_recorder_triggers);
+    std::string trigger;
+    while (std::getline(triggers, trigger, ','))
+    {
+        NS_ABORT_MSG_IF(trigger != "rto" && trigger != "recovery" && trigger != "collapse",
+                        "Unknown flight recorder trigger " << trigger);
+        m_triggers.insert(trigger);
+    }
+}
+
+void
+FlightRecorder::RegisterFlowAddress(Ipv4Address address, uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << address << nodeId);
+    m_flowAddresses[address.Get()] = nodeId;
+}
+
+void
+FlightRecorder::ConnectFlow(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+
+    Config::MatchContainer sockets = Config::LookupMatches(
+        "/NodeList/" + std::to_string(nodeId) + "/$ns3::TcpL4Protocol/SocketList/0");
+    if (sockets.GetN() == 0)
+    {
+        NS_LOG_WARN("Node " << nodeId << " has no socket to record");
+        return;
+    }
+
+    FlowRecorder* flow = &m_flows[nodeId];
+    flow->nodeId = nodeId;
+    flow->socket = DynamicCast<TcpSocketBase>(sockets.Get(0));
+    flow->events.resize(m_mask + 1);
+    Ptr<Object> socket = sockets.Get(0);
+    socket->TraceConnectWithoutContext("Rx",
+                                       MakeBoundCallback(&FlightRecorder::RxTracer, this, flow));
+    socket->TraceConnectWithoutContext("Tx",
+                                       MakeBoundCallback(&FlightRecorder::TxTracer, this, flow));
+    socket->TraceConnectWithoutContext(
+        "CongestionWindow",
+        MakeBoundCallback(&FlightRecorder::CwndTracer, this, flow));
+    socket->TraceConnectWithoutContext(
+        "SlowStartThreshold",
+        MakeBoundCallback(&FlightRecorder::SsThreshTracer, this, flow));
+    socket->TraceConnectWithoutContext(
+        "CongState",
+        MakeBoundCallback(&FlightRecorder::CongStateTracer, this, flow));
+    socket->TraceConnectWithoutContext("State",
+                                       MakeBoundCallback(&FlightRecorder::StateTracer, this, flow));
+
+    if (m_triggers.count("collapse") != 0 && !m_collapseScheduled)
+    {
+        m_collapseScheduled = true;
+        Simulator::Schedule(COLLAPSE_INTERVAL, &FlightRecorder::CheckCollapse, this);
+    }
+}
+
+void
+FlightRecorder::QueueDiscDropTracer(Ptr<const QueueDiscItem> item)
+{
+    Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem>(item);
+    if (!ipv4Item)
+        return;
+    auto address = m_flowAddresses.find(ipv4Item->GetHeader().GetSource().Get());
+    if (address == m_flowAddresses.end())
+        return;
+    auto flow = m_flows.find(address->second);
+    if (flow == m_flows.end())
+        return;
+
+    TcpHeader header;
+    uint32_t seq = 0;
+    if (ipv4Item->GetHeader().GetProtocol() == 6 && item->GetPacket()->PeekHeader(header) != 0)
+        seq = header.GetSequenceNumber().GetValue();
+    Record(flow->second, FlightEventType::QueueDrop, seq);
+}
+
+void
+FlightRecorder::RxTracer(FlightRecorder* recorder,
+                         FlowRecorder* flow,
+                         Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket)
+{
+    if (!(header.GetFlags() & TcpHeader::ACK))
+        return;
+
+    uint32_t ack = header.GetAckNumber().GetValue();
+    if (ack == flow->lastAck)
+    {
+        recorder->Record(*flow, FlightEventType::DupAck, ack);
+        return;
+    }
+    if (flow->lastAck != 0)
+        flow->ackedBytes += ack - flow->lastAck;
+    flow->lastAck = ack;
+    recorder->Record(*flow, FlightEventType::Ack, ack);
+}
+
+void
+FlightRecorder::TxTracer(FlightRecorder* recorder,
+                         FlowRecorder* flow,
+                         Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket)
+{
+    uint32_t seq = header.GetSequenceNumber().GetValue();
+    if (seq < flow->highestTx)
+        recorder->Record(*flow, FlightEventType::Retransmit, seq);
+    else
+        flow->highestTx = seq;
+}
+
+void
+FlightRecorder::CwndTracer(FlightRecorder* recorder,
+                           FlowRecorder* flow,
+                           uint32_t oldval,
+                           uint32_t newval)
+{
+    recorder->Record(*flow, FlightEventType::Cwnd, newval);
+}
+
+void
+FlightRecorder::SsThreshTracer(FlightRecorder* recorder,
+                               FlowRecorder* flow,
+                               uint32_t oldval,
+                               uint32_t newval)
+{
+    recorder->Record(*flow, FlightEventType::SsThresh, newval);
+}
+
+void
+FlightRecorder::CongStateTracer(FlightRecorder* recorder,
+                                FlowRecorder* flow,
+                                TcpSocketState::TcpCongState_t oldval,
+                                TcpSocketState::TcpCongState_t newval)
+{
+    recorder->Record(*flow, FlightEventType::CongState, newval);
+
+    if (newval == TcpSocketState::CA_LOSS && recorder->m_triggers.count("rto") != 0)
+        recorder->Dump(*flow, "rto");
+    else if (newval == TcpSocketState::CA_RECOVERY && recorder->m_triggers.count("recovery") != 0)
+        recorder->Dump(*flow, "recovery");
+}
+
+void
+FlightRecorder::StateTracer(FlightRecorder* recorder,
+                            FlowRecorder* flow,
+                            TcpStates_t oldval,
+                            TcpStates_t newval)
+{
+    // The sender sends its FIN once all its data has been sent, or the connection failed
+    if (newval == CLOSED || newval >= LAST_ACK)
+        flow->closed = true;
+}
+
+void
+FlightRecorder::Record(FlowRecorder& flow, FlightEventType type, uint32_t value)
+{
+    flow.events[flow.head & m_mask] = {static_cast<uint64_t>(Simulator::Now().GetNanoSeconds()),
+                                       value,
+                                       type};
+    ++flow.head;
+}
+
+void
+FlightRecorder::CheckCollapse()
+{
+    NS_LOG_FUNCTION(this);
+
+    bool open = false;
+    for (auto& [nodeId, flow] : m_flows)
+    {
+        open = open || !flow.closed;
+        // A flow with nothing left to send acknowledges nothing, which is not a collapse
+        if (flow.closed || flow.socket->GetTxBuffer()->Size() == 0)
+        {
+            flow.ackedBytes = 0;
+            continue;
+        }
+        if (flow.collapsed)
+            flow.collapsed = flow.ackedBytes < RECOVERY_RATIO * flow.avgAckedBytes;
+        else if (flow.avgAckedBytes > 0 && flow.ackedBytes < COLLAPSE_RATIO * flow.avgAckedBytes)
+        {
+            flow.collapsed = true;
+            Dump(flow, "collapse");
+        }
+        flow.avgAckedBytes = flow.avgAckedBytes == 0
+                                 ? flow.ackedBytes
+                                 : 0.8 * flow.avgAckedBytes + 0.2 * flow.ackedBytes;
+        flow.ackedBytes = 0;
+    }
+    if (open)
+        Simulator::Schedule(COLLAPSE_INTERVAL, &FlightRecorder::CheckCollapse, this);
+    else
+        m_collapseScheduled = false;
+}
+
+void
+FlightRecorder::Dump(FlowRecorder& flow, const std::string& trigger)
+{
+    NS_LOG_FUNCTION(this << flow.nodeId << trigger);
+
+    static const char* const eventNames[] =
+        {"ACK", "DUPACK", "CWND", "SSTHRESH", "RETRANSMIT", "QUEUE_DROP", "CONG_STATE"};
+
+    if (flow.dumps >= MAX_DUMPS_PER_FLOW)
+        return;
+
+    std::ofstream dumpFile(m_conf.prefix_file_name + "-flight-" + std::to_string(flow.nodeId) +
+                           "-" + std::to_string(flow.dumps++) + ".txt");
+    dumpFile << "# Node: " << flow.nodeId << " Trigger: " << trigger
+             << " Time (s): " << Simulator::Now().GetSeconds() << std::endl;
+    uint64_t first = flow.head > m_mask + 1 ? flow.head - m_mask - 1 : 0;
+    for (uint64_t i = first; i < flow.head; ++i)
+    {
+        const FlightEvent& event = flow.events[i & m_mask];
+        dumpFile << event.time / 1e9 << "\t" << eventNames[static_cast<uint8_t>(event.type)]
+                 << "\t";
+        if (event.type == FlightEventType::CongState)
+            dumpFile << TcpSocketState::TcpCongStateName[event.value];
+        else
+            dumpFile << event.value;
+        dumpFile << std::endl;
+    }
+    dumpFile.close();
+    NS_LOG_INFO("Flight recorder of node " << flow.nodeId << " dumped on " << trigger);
+}
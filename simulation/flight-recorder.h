@@ -0,0 +1,202 @@
+#ifndef P2P_SIMULATION_FLIGHT_RECORDER_H
+#define P2P_SIMULATION_FLIGHT_RECORDER_H
+
+#include "configuration.h"
+
+#include "ns3/core-module.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/queue-item.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-socket-base.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * @brief Type of an event stored by the flight recorder.
+ */
+enum class FlightEventType : uint8_t
+{
+    Ack,        //!< New cumulative ACK received. Value: ACK number.
+    DupAck,     //!< Duplicate ACK received. Value: ACK number.
+    Cwnd,       //!< Congestion window changed. Value: new cwnd.
+    SsThresh,   //!< Slow start threshold changed. Value: new ssthresh.
+    Retransmit, //!< Segment sent again. Value: sequence number.
+    QueueDrop,  //!< Segment dropped by the bottleneck queue. Value: sequence number.
+    CongState,  //!< Congestion state changed. Value: new TcpSocketState::TcpCongState_t.
+};
+
+/**
+ * @brief Single event stored by the flight recorder.
+ */
+struct FlightEvent
+{
+    uint64_t time;        //!< Time of the event (ns).
+    uint32_t value;       //!< Value of the event, depending on its type.
+    FlightEventType type; //!< Type of the event.
+};
+
+/**
+ * @brief FlightRecorder class.
+ * It keeps the last flight_recorder_size TCP events of each flow in a fixed ring buffer, and
+ * writes them to <prefix_file_name>-flight-<node>-<n>.txt only when a trigger fires:
+ * - "rto": the retransmission timer expired (the flow entered CA_LOSS).
+ * - "recovery": the flow entered CA_RECOVERY, i.e. the recovery ops EnterRecovery was called
+ *   (TcpTahoeLossRecovery::EnterRecovery for Tahoe flows).
+ * - "collapse": the bytes acknowledged in the last interval dropped well below their average. It
+ *   fires once for each drop, and again only after the throughput has recovered. The flows with
+ *   nothing left to send, or whose socket has been closed, are not checked.
+ * Recording an event is a single store in a preallocated buffer, with no allocation and no lock,
+ * so the recorder can stay enabled for the whole run.
+ */
+class FlightRecorder
+{
+  public:
+    /**
+     * @brief FlightRecorder constructor.
+     * @param conf simulation configuration.
+     */
+    FlightRecorder(const Configuration& conf);
+
+    /**
+     * @brief Associate the address of a sender with its flow.
+     * Used to attribute the queue drops to the right flow.
+     * @param address address of the sender.
+     * @param nodeId id of the sender node.
+     */
+    void RegisterFlowAddress(Ipv4Address address, uint32_t nodeId);
+    /**
+     * @brief Start recording the events of a flow.
+     * Must be scheduled right after the sender application has started, so that its socket
+     * exists.
+     * @param nodeId id of the sender node.
+     */
+    void ConnectFlow(uint32_t nodeId);
+    /**
+     * @brief Trace the packets dropped by the bottleneck queue disc.
+     * @param item packet dropped.
+     */
+    void QueueDiscDropTracer(Ptr<const QueueDiscItem> item);
+
+  private:
+    /**
+     * @brief Ring buffer and state of a single flow.
+     */
+    struct FlowRecorder
+    {
+        uint32_t nodeId = 0;             //!< Id of the sender node.
+        Ptr<TcpSocketBase> socket;       //!< Sender socket.
+        std::vector<FlightEvent> events; //!< Ring buffer of the last events.
+        uint64_t head = 0;               //!< Number of events recorded so far.
+        uint32_t lastAck = 0;            //!< Last ACK number received.
+        uint32_t highestTx = 0;          //!< Highest sequence number sent.
+        uint32_t ackedBytes = 0;         //!< Bytes acknowledged in the current interval.
+        double avgAckedBytes = 0;        //!< Moving average of the bytes acknowledged per interval.
+        bool collapsed = false;          //!< True from a collapse until the throughput recovers.
+        bool closed = false;             //!< True once the socket is closing or closed.
+        uint32_t dumps = 0;              //!< Number of dumps written.
+    };
+
+    /**
+     * @brief Trace the segments received by the sender, i.e. the ACKs.
+     * @param recorder flight recorder.
+     * @param flow recorder of the flow.
+     * @param packet segment received.
+     * @param header TCP header of the segment.
+     * @param socket sender socket.
+     */
+    static void RxTracer(FlightRecorder* recorder,
+                         FlowRecorder* flow,
+                         Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket);
+    /**
+     * @brief Trace the segments sent by the sender, to spot the retransmissions.
+     * @param recorder flight recorder.
+     * @param flow recorder of the flow.
+     * @param packet segment sent.
+     * @param header TCP header of the segment.
+     * @param socket sender socket.
+     */
+    static void TxTracer(FlightRecorder* recorder,
+                         FlowRecorder* flow,
+                         Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket);
+    /**
+     * @brief Trace the congestion window.
+     * @param recorder flight recorder.
+     * @param flow recorder of the flow.
+     * @param oldval old congestion window value.
+     * @param newval new congestion window value.
+     */
+    static void CwndTracer(FlightRecorder* recorder,
+                           FlowRecorder* flow,
+                           uint32_t oldval,
+                           uint32_t newval);
+    /**
+     * @brief Trace the slow start threshold.
+     * @param recorder flight recorder.
+     * @param flow recorder of the flow.
+     * @param oldval old slow start threshold value.
+     * @param newval new slow start threshold value.
+     */
+    static void SsThreshTracer(FlightRecorder* recorder,
+                               FlowRecorder* flow,
+                               uint32_t oldval,
+                               uint32_t newval);
+    /**
+     * @brief Trace the congestion state, firing the "rto" and "recovery" triggers.
+     * @param recorder flight recorder.
+     * @param flow recorder of the flow.
+     * @param oldval old congestion state.
+     * @param newval new congestion state.
+     */
+    static void CongStateTracer(FlightRecorder* recorder,
+                                FlowRecorder* flow,
+                                TcpSocketState::TcpCongState_t oldval,
+                                TcpSocketState::TcpCongState_t newval);
+    /**
+     * @brief Trace the state of the socket, to stop checking the flow once it is closed.
+     * @param recorder flight recorder.
+     * @param flow recorder of the flow.
+     * @param oldval old socket state.
+     * @param newval new socket state.
+     */
+    static void StateTracer(FlightRecorder* recorder,
+                            FlowRecorder* flow,
+                            TcpStates_t oldval,
+                            TcpStates_t newval);
+
+    /**
+     * @brief Store an event in the ring buffer of a flow.
+     * @param flow flow the event belongs to.
+     * @param type type of the event.
+     * @param value value of the event.
+     */
+    void Record(FlowRecorder& flow, FlightEventType type, uint32_t value);
+    /**
+     * @brief Check every flow for a throughput collapse, then schedule the next check while a
+     * flow is still open.
+     */
+    void CheckCollapse();
+    /**
+     * @brief Write the events of a flow to a file, oldest first.
+     * @param flow recorder of the flow.
+     * @param trigger name of the trigger that fired.
+     */
+    void Dump(FlowRecorder& flow, const std::string& trigger);
+
+  private:
+    const Configuration& m_conf;                   //!< Configuration
+    uint32_t m_mask;                               //!< Size of the ring buffers minus one
+    std::set<std::string> m_triggers;              //!< Enabled triggers
+    std::map<uint32_t, FlowRecorder> m_flows;      //!< Recorder of each flow
+    std::map<uint32_t, uint32_t> m_flowAddresses;  //!< Node id of each sender address
+    bool m_collapseScheduled;                      //!< True if the collapse check is scheduled
+};
+
+#endif /* P2P_SIMULATION_FLIGHT_RECORDER_H */
@@ -0,0 +1,399 @@
+#include "flow-workload.h"
+
+#include "ns3/data-rate.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-socket-factory.h"
+
+#include <fstream>
+
+NS_LOG_COMPONENT_DEFINE("FlowWorkload");
+NS_OBJECT_ENSURE_REGISTERED(FlowWorkloadApplication);
+
+/*********************************
+ * FlowCompletionTracker
+ *********************************/
+
+FlowCompletionTracker::FlowCompletionTracker(const Configuration& conf)
+    : m_conf(conf),
+      m_bottleneckRate(std::min(DataRate(conf.s_bandwidth).GetBitRate(),
+                                DataRate(conf.r_bandwidth).GetBitRate())),
+      m_oneWayDelay((Time(conf.s_delay) + Time(conf.r_delay)).GetSeconds()),
+      m_pendingFlows(0)
+{
+}
+
+void
+FlowCompletionTracker::FlowStarted(uint32_t nodeId, Ptr<Socket> socket, uint64_t size)
+{
+    NS_LOG_FUNCTION(this << nodeId << socket << size);
+
+    Address local;
+    socket->GetSockName(local);
+    uint64_t key = GetConnectionKey(InetSocketAddress::ConvertFrom(local));
+    m_connections[key].push_back({nodeId, size, size, Simulator::Now()});
+    ++m_pendingFlows;
+}
+
+void
+FlowCompletionTracker::SinkRxTracer(Ptr<const Packet> packet, const Address& from)
+{
+    NS_LOG_FUNCTION(this << packet << from);
+
+    auto it = m_connections.find(GetConnectionKey(InetSocketAddress::ConvertFrom(from)));
+    if (it == m_connections.end())
+        return;
+
+    // The bytes of the packet may complete a flow and belong to the next one on the connection
+    uint64_t bytes = packet->GetSize();
+    std::deque<PendingFlow>& flows = it->second;
+    while (bytes > 0 && !flows.empty())
+    {
+        PendingFlow& flow = flows.front();
+        uint64_t consumed = std::min(bytes, flow.remaining);
+        flow.remaining -= consumed;
+        bytes -= consumed;
+        if (flow.remaining > 0)
+            break;
+
+        double fct = (Simulator::Now() - flow.start).GetSeconds();
+        m_records.push_back({flow.nodeId,
+                             flow.size,
+                             flow.start.GetSeconds(),
+                             fct,
+                             fct / GetIdealCompletionTime(flow.size)});
+        NS_LOG_DEBUG("Node: " << flow.nodeId << " Size: " << flow.size << " FCT: " << fct);
+        flows.pop_front();
+        --m_pendingFlows;
+    }
+}
+
+const std::vector<FlowRecord>&
+FlowCompletionTracker::GetRecords() const
+{
+    return m_records;
+}
+
+uint64_t
+FlowCompletionTracker::GetPendingFlows() const
+{
+    return m_pendingFlows;
+}
+
+void
+FlowCompletionTracker::PrintResults() const
+{
+    // Upper bound (bytes, excluded) of each size bucket
+    static const std::vector<std::pair<uint64_t, std::string>> buckets = {
+        {10000, "<10KB"},
+        {100000, "10KB-100KB"},
+        {1000000, "100KB-1MB"},
+        {std::numeric_limits<uint64_t>::max(), ">=1MB"}};
+
+    std::vector<std::vector<double>> slowdowns(buckets.size());
+    for (const FlowRecord& record : m_records)
+    {
+        std::size_t i = 0;
+        while (record.size >= buckets[i].first)
+            ++i;
+        slowdowns[i].push_back(record.slowdown);
+    }
+
+    std::cout << "============= FCT slowdown =============" << std::endl;
+    std::cout << "Completed flows: " << m_records.size() << " Pending flows: " << m_pendingFlows
+              << std::endl;
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+    {
+        std::vector<double>& values = slowdowns[i];
+        std::cout << buckets[i].second << "\tflows: " << values.size();
+        for (double percentile : {0.5, 0.95, 0.99})
+        {
+            if (values.empty())
+                break;
+            auto nth = values.begin() + static_cast<std::size_t>(percentile * (values.size() - 1));
+            std::nth_element(values.begin(), nth, values.end());
+            std::cout << "\tp" << static_cast<uint32_t>(percentile * 100) << ": " << *nth;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+
+    std::ofstream fctFile(m_conf.prefix_file_name + "-fct.csv");
+    fctFile << "node,size,start,fct,slowdown" << std::endl;
+    for (const auto& [nodeId, size, start, fct, slowdown] : m_records)
+    {
+        fctFile << nodeId << "," << size << "," << start << "," << fct << "," << slowdown
+                << std::endl;
+    }
+    fctFile.close();
+}
+
+uint64_t
+FlowCompletionTracker::GetConnectionKey(const InetSocketAddress& address)
+{
+    return (static_cast<uint64_t>(address.GetIpv4().Get()) << 16) | address.GetPort();
+}
+
+double
+FlowCompletionTracker::GetIdealCompletionTime(uint64_t size) const
+{
+    return m_oneWayDelay + size * 8.0 / m_bottleneckRate;
+}
+
+/*********************************
+ * FlowWorkloadApplication
+ *********************************/
+
+TypeId
+FlowWorkloadApplication::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::FlowWorkloadApplication")
+                            .SetParent<Application>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<FlowWorkloadApplication>();
+    return tid;
+}
+
+FlowWorkloadApplication::FlowWorkloadApplication()
+    : m_tracker(nullptr),
+      m_reuse(true),
+      m_maxConnections(1),
+      m_sndBufSize(0),
+      m_segmentSize(0),
+      m_pacing(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+FlowWorkloadApplication::~FlowWorkloadApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FlowWorkloadApplication::Setup(const Configuration& conf,
+                               const Address& remote,
+                               FlowCompletionTracker& tracker,
+                               bool pacing)
+{
+    NS_LOG_FUNCTION(this << remote);
+    NS_ABORT_MSG_IF(conf.flow_arrival_rate <= 0, "The flow arrival rate must be positive");
+
+    m_remote = remote;
+    m_tracker = &tracker;
+    m_reuse = conf.connection_reuse;
+    m_maxConnections = std::max<uint32_t>(conf.max_connections, 1);
+    m_sndBufSize = conf.snd_buf_size;
+    m_segmentSize = conf.adu_bytes;
+    m_pacing = pacing;
+
+    m_arrival = CreateObject<ExponentialRandomVariable>();
+    m_arrival->SetAttribute("Mean", DoubleValue(1.0 / conf.flow_arrival_rate));
+
+    if (conf.flow_size_dist == "pareto")
+    {
+        NS_ABORT_MSG_IF(conf.flow_size_shape <= 1, "The pareto shape must be greater than 1");
+        Ptr<ParetoRandomVariable> pareto = CreateObject<ParetoRandomVariable>();
+        // The mean of a pareto distribution is scale * shape / (shape - 1)
+        pareto->SetAttribute(
+            "Scale",
+            DoubleValue(conf.flow_size_mean * (conf.flow_size_shape - 1) / conf.flow_size_shape));
+        pareto->SetAttribute("Shape", DoubleValue(conf.flow_size_shape));
+        m_flowSize = pareto;
+    }
+    else if (conf.flow_size_dist == "empirical")
+    {
+        std::ifstream cdfFile(conf.flow_size_cdf);
+        NS_ABORT_MSG_IF(!cdfFile.is_open(), "Cannot open the flow size CDF " << conf.flow_size_cdf);
+        Ptr<EmpiricalRandomVariable> empirical = CreateObject<EmpiricalRandomVariable>();
+        double size;
+        double cdf = 0;
+        while (cdfFile >> size >> cdf)
+        {
+            empirical->CDF(size, cdf);
+        }
+        NS_ABORT_MSG_IF(cdf != 1.0, "The flow size CDF must end with probability 1");
+        m_flowSize = empirical;
+    }
+    else
+    {
+        NS_ABORT_MSG("Unknown flow size distribution " << conf.flow_size_dist);
+    }
+}
+
+void
+FlowWorkloadApplication::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_connections.clear();
+    m_arrival = nullptr;
+    m_flowSize = nullptr;
+    Application::DoDispose();
+}
+
+void
+FlowWorkloadApplication::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Open the first connection right away, so that its socket can be traced
+    OpenConnection();
+    m_arrivalEvent = Simulator::Schedule(Seconds(m_arrival->GetValue()),
+                                         &FlowWorkloadApplication::FlowArrival,
+                                         this);
+}
+
+void
+FlowWorkloadApplication::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    Simulator::Cancel(m_arrivalEvent);
+    for (Connection& conn : m_connections)
+    {
+        conn.socket->SetSendCallback(MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+        conn.socket->Close();
+    }
+    m_connections.clear();
+}
+
+void
+FlowWorkloadApplication::FlowArrival()
+{
+    NS_LOG_FUNCTION(this);
+
+    uint64_t size = std::max<uint64_t>(1, static_cast<uint64_t>(m_flowSize->GetValue()));
+    Connection& conn = m_connections[SelectConnection()];
+    conn.used = true;
+    m_tracker->FlowStarted(GetNode()->GetId(), conn.socket, size);
+    conn.pending += size;
+    NS_LOG_DEBUG("New flow of " << size << " bytes on socket " << conn.socket);
+    if (conn.connected)
+        SendPending(conn);
+
+    m_arrivalEvent = Simulator::Schedule(Seconds(m_arrival->GetValue()),
+                                         &FlowWorkloadApplication::FlowArrival,
+                                         this);
+}
+
+std::size_t
+FlowWorkloadApplication::OpenConnection()
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<Socket> socket = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+    if (m_pacing)
+        DynamicCast<TcpSocketBase>(socket)->SetPacingStatus(true);
+    socket->Bind();
+    socket->Connect(m_remote);
+    socket->SetConnectCallback(MakeCallback(&FlowWorkloadApplication::ConnectionSucceeded, this),
+                               MakeCallback(&FlowWorkloadApplication::ConnectionFailed, this));
+    socket->SetSendCallback(MakeCallback(&FlowWorkloadApplication::DataSendable, this));
+    m_connections.push_back({socket, 0, false, false});
+    return m_connections.size() - 1;
+}
+
+std::size_t
+FlowWorkloadApplication::SelectConnection()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_reuse)
+    {
+        // Close the connections whose flows have been fully acknowledged
+        for (auto it = m_connections.begin(); it != m_connections.end();)
+        {
+            if (it->used && IsIdle(*it))
+            {
+                it->socket->Close();
+                it = m_connections.erase(it);
+            }
+            else
+                ++it;
+        }
+        // The connection opened at the start carries the first flow
+        for (std::size_t i = 0; i < m_connections.size(); ++i)
+        {
+            if (!m_connections[i].used)
+                return i;
+        }
+        return OpenConnection();
+    }
+
+    std::size_t leastLoaded = 0;
+    for (std::size_t i = 0; i < m_connections.size(); ++i)
+    {
+        if (IsIdle(m_connections[i]))
+            return i;
+        if (m_connections[i].pending < m_connections[leastLoaded].pending)
+            leastLoaded = i;
+    }
+    if (m_connections.size() < m_maxConnections)
+        return OpenConnection();
+    // All the connections are busy, so the flow has to wait behind the least loaded one
+    return leastLoaded;
+}
+
+bool
+FlowWorkloadApplication::IsIdle(const Connection& conn) const
+{
+    return conn.connected && conn.pending == 0 && conn.socket->GetTxAvailable() == m_sndBufSize;
+}
+
+void
+FlowWorkloadApplication::SendPending(Connection& conn)
+{
+    NS_LOG_FUNCTION(this << conn.socket << conn.pending);
+
+    while (conn.pending > 0)
+    {
+        uint32_t available = conn.socket->GetTxAvailable();
+        if (available == 0)
+            break;
+        uint32_t toSend = std::min<uint64_t>({conn.pending, available, m_segmentSize});
+        int sent = conn.socket->Send(Create<Packet>(toSend));
+        if (sent <= 0)
+            break;
+        conn.pending -= sent;
+    }
+}
+
+FlowWorkloadApplication::Connection*
+FlowWorkloadApplication::FindConnection(Ptr<Socket> socket)
+{
+    for (Connection& conn : m_connections)
+    {
+        if (conn.socket == socket)
+            return &conn;
+    }
+    return nullptr;
+}
+
+void
+FlowWorkloadApplication::ConnectionSucceeded(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+
+    Connection* conn = FindConnection(socket);
+    if (conn == nullptr)
+        return;
+    conn->connected = true;
+    SendPending(*conn);
+}
+
+void
+FlowWorkloadApplication::ConnectionFailed(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    NS_LOG_WARN("Connection to the sink failed on node " << GetNode()->GetId());
+}
+
+void
+FlowWorkloadApplication::DataSendable(Ptr<Socket> socket, uint32_t available)
+{
+    NS_LOG_FUNCTION(this << socket << available);
+
+    Connection* conn = FindConnection(socket);
+    if (conn != nullptr && conn->connected)
+        SendPending(*conn);
+}
@@ -0,0 +1,217 @@
+#ifndef P2P_SIMULATION_FLOW_WORKLOAD_H
+#define P2P_SIMULATION_FLOW_WORKLOAD_H
+
+#include "configuration.h"
+
+#include "ns3/application.h"
+#include "ns3/core-module.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+
+#include <deque>
+#include <unordered_map>
+
+using namespace ns3;
+
+/**
+ * @brief Completion record of a single short flow.
+ */
+struct FlowRecord
+{
+    uint32_t nodeId;  //!< Id of the sender node.
+    uint64_t size;    //!< Size of the flow in bytes.
+    double start;     //!< Time the flow arrived at the sender (s).
+    double fct;       //!< Flow completion time (s).
+    double slowdown;  //!< Flow completion time divided by the ideal completion time.
+};
+
+/**
+ * @brief FlowCompletionTracker class.
+ * It keeps track of the flows started by the FlowWorkloadApplications and computes their flow
+ * completion time (FCT) by looking at the bytes received by the sink.
+ * Flows that share a connection are delimited by their size, since TCP delivers the bytes in
+ * order.
+ */
+class FlowCompletionTracker
+{
+  public:
+    /**
+     * @brief FlowCompletionTracker constructor.
+     * @param conf simulation configuration.
+     */
+    FlowCompletionTracker(const Configuration& conf);
+
+    /**
+     * @brief Register a new flow.
+     * @param nodeId id of the sender node.
+     * @param socket sender socket the flow will be sent on. It must already be connected or
+     * connecting, so that its local address is known.
+     * @param size size of the flow in bytes.
+     */
+    void FlowStarted(uint32_t nodeId, Ptr<Socket> socket, uint64_t size);
+    /**
+     * @brief Trace the bytes received by the sink.
+     * @param packet packet received.
+     * @param from address of the sender socket.
+     */
+    void SinkRxTracer(Ptr<const Packet> packet, const Address& from);
+
+    /**
+     * @brief Completed flows getter.
+     * @return records of the completed flows.
+     */
+    const std::vector<FlowRecord>& GetRecords() const;
+    /**
+     * @brief Get the number of flows that have started but not completed yet.
+     * @return number of pending flows.
+     */
+    uint64_t GetPendingFlows() const;
+    /**
+     * @brief Print the FCT slowdown percentiles for each size bucket to the console and the
+     * record of each completed flow to <prefix_file_name>-fct.csv.
+     */
+    void PrintResults() const;
+
+  private:
+    /**
+     * @brief Flow that has been started but not fully received yet.
+     */
+    struct PendingFlow
+    {
+        uint32_t nodeId;    //!< Id of the sender node.
+        uint64_t size;      //!< Size of the flow in bytes.
+        uint64_t remaining; //!< Bytes not received yet.
+        Time start;         //!< Time the flow arrived at the sender.
+    };
+
+    /**
+     * @brief Compute the key of a connection from the address of the sender socket.
+     * @param address address of the sender socket.
+     * @return key of the connection.
+     */
+    static uint64_t GetConnectionKey(const InetSocketAddress& address);
+    /**
+     * @brief Compute the completion time of a flow alone on an empty network.
+     * @param size size of the flow in bytes.
+     * @return ideal flow completion time (s).
+     */
+    double GetIdealCompletionTime(uint64_t size) const;
+
+  private:
+    const Configuration& m_conf; //!< Configuration
+    double m_bottleneckRate;     //!< Rate of the slowest link on the path (bit/s).
+    double m_oneWayDelay;        //!< Propagation delay from a sender to the receiver (s).
+    uint64_t m_pendingFlows;     //!< Number of flows not completed yet.
+    std::unordered_map<uint64_t, std::deque<PendingFlow>> m_connections; //!< Flows per connection
+    std::vector<FlowRecord> m_records; //!< Completed flows
+};
+
+/**
+ * @brief FlowWorkloadApplication class.
+ * Short flow traffic generator.
+ * New flows arrive following a Poisson process and their size is drawn from a heavy-tailed
+ * distribution (pareto or empirical CDF).
+ * When connection reuse is enabled, a new flow is sent on an idle connection, if any, instead of
+ * paying for a new handshake and a new slow start.
+ * The first connection is opened when the application starts, whether connections are reused or
+ * not, and it is the only one traced.
+ */
+class FlowWorkloadApplication : public Application
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId.
+     */
+    static TypeId GetTypeId();
+    /**
+     * @brief FlowWorkloadApplication constructor.
+     */
+    FlowWorkloadApplication();
+    /**
+     * @brief FlowWorkloadApplication destructor.
+     */
+    ~FlowWorkloadApplication() override;
+
+    /**
+     * @brief Setup the application.
+     * Must be called before the application starts.
+     * @param conf simulation configuration.
+     * @param remote address of the sink.
+     * @param tracker tracker used to measure the flow completion time.
+     * @param pacing whether the sockets pace, as needed by the TCP variant of the sender.
+     */
+    void Setup(const Configuration& conf,
+               const Address& remote,
+               FlowCompletionTracker& tracker,
+               bool pacing);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * @brief Connection to the sink, possibly shared by many flows.
+     */
+    struct Connection
+    {
+        Ptr<Socket> socket;   //!< Sender socket.
+        uint64_t pending;     //!< Bytes not handed to the socket yet.
+        bool connected;       //!< True if the handshake has completed.
+        bool used;            //!< True once a flow has been sent on it.
+    };
+
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * @brief A new flow arrives. Schedule the next arrival.
+     */
+    void FlowArrival();
+    /**
+     * @brief Open a new connection towards the sink.
+     * @return index of the connection.
+     */
+    std::size_t OpenConnection();
+    /**
+     * @brief Find the connection a new flow should be sent on.
+     * @return index of the connection.
+     */
+    std::size_t SelectConnection();
+    /**
+     * @brief Check if a connection has no data left to send or to be acknowledged.
+     * @param conn connection to check.
+     * @return true if the connection is idle.
+     */
+    bool IsIdle(const Connection& conn) const;
+    /**
+     * @brief Hand as many pending bytes as possible to the socket.
+     * @param conn connection to send the data on.
+     */
+    void SendPending(Connection& conn);
+    /**
+     * @brief Find the connection the socket belongs to.
+     * @param socket socket to look for.
+     * @return connection of the socket, or nullptr.
+     */
+    Connection* FindConnection(Ptr<Socket> socket);
+
+    void ConnectionSucceeded(Ptr<Socket> socket);
+    void ConnectionFailed(Ptr<Socket> socket);
+    void DataSendable(Ptr<Socket> socket, uint32_t available);
+
+  private:
+    Address m_remote;                         //!< Address of the sink.
+    FlowCompletionTracker* m_tracker;         //!< Flow completion time tracker.
+    bool m_reuse;                             //!< Whether idle connections are reused.
+    uint32_t m_maxConnections;                //!< Maximum number of open connections.
+    uint32_t m_sndBufSize;                    //!< Send buffer size of each socket.
+    uint32_t m_segmentSize;                   //!< Size of the chunks handed to the socket.
+    bool m_pacing;                            //!< Whether the sockets pace.
+    Ptr<ExponentialRandomVariable> m_arrival; //!< Inter-arrival time of the flows (s).
+    Ptr<RandomVariableStream> m_flowSize;     //!< Size of the flows (bytes).
+    std::vector<Connection> m_connections;    //!< Connections to the sink.
+    EventId m_arrivalEvent;                   //!< Next flow arrival.
+};
+
+#endif /* P2P_SIMULATION_FLOW_WORKLOAD_H */
@@ -0,0 +1,99 @@
+#include "link-controller.h"
+
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("LinkController");
+
+LinkController::LinkController(const Configuration& conf, Tracer& tracer)
+    : m_tracer(tracer),
+      m_nextChange(0)
+{
+    NS_ABORT_MSG_IF(!conf.link_schedule.empty() && !conf.link_trace.empty(),
+                    "Only one of link_schedule and link_trace can be used");
+
+    // Piecewise schedule: <time>:<data rate>[:<delay>],...
+    std::istringstream schedule(conf.link_schedule);
+    std::string step;
+    while (std::getline(schedule, step, ','))
+    {
+        std::istringstream stepStream(step);
+        std::string time, dataRate, delay;
+        std::getline(stepStream, time, ':');
+        std::getline(stepStream, dataRate, ':');
+        std::getline(stepStream, delay, ':');
+        m_changes.push_back(ParseChange(time, dataRate, delay));
+    }
+
+    // Capacity trace: one "<time> <data rate> [<delay>]" line for each change
+    if (!conf.link_trace.empty())
+    {
+        std::ifstream traceFile(conf.link_trace);
+        NS_ABORT_MSG_IF(!traceFile.is_open(), "Cannot open the link trace " << conf.link_trace);
+        std::string line;
+        while (std::getline(traceFile, line))
+        {
+            std::istringstream lineStream(line);
+            std::string time, dataRate, delay;
+            if (!(lineStream >> time >> dataRate))
+                continue;
+            lineStream >> delay;
+            m_changes.push_back(ParseChange(time, dataRate, delay));
+        }
+    }
+
+    std::stable_sort(m_changes.begin(),
+                     m_changes.end(),
+                     [](const LinkChange& a, const LinkChange& b) { return a.time < b.time; });
+}
+
+void
+LinkController::Install(const NetDeviceContainer& devices)
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_changes.empty())
+        return;
+    m_devices = devices;
+    Simulator::Schedule(m_changes.front().time, &LinkController::ApplyNextChange, this);
+}
+
+LinkController::LinkChange
+LinkController::ParseChange(const std::string& time,
+                            const std::string& dataRate,
+                            const std::string& delay)
+{
+    NS_ABORT_MSG_IF(time.empty() || dataRate.empty(), "Invalid link change " << time);
+    std::istringstream timeStream(time);
+    double seconds;
+    char extra;
+    NS_ABORT_MSG_IF(!(timeStream >> seconds) || timeStream >> extra,
+                    "Invalid time of a link change " << time);
+    NS_ABORT_MSG_IF(seconds < 0, "The time of a link change cannot be negative");
+    return {Seconds(seconds), DataRate(dataRate), delay.empty() ? Seconds(-1) : Time(delay)};
+}
+
+void
+LinkController::ApplyNextChange()
+{
+    NS_LOG_FUNCTION(this);
+
+    const LinkChange& change = m_changes[m_nextChange++];
+    NS_LOG_INFO("Link changed to " << change.dataRate << " " << change.delay);
+    for (uint32_t i = 0; i < m_devices.GetN(); i++)
+    {
+        m_devices.Get(i)->SetAttribute("DataRate", DataRateValue(change.dataRate));
+    }
+    if (!change.delay.IsNegative())
+        m_devices.Get(0)->GetChannel()->SetAttribute("Delay", TimeValue(change.delay));
+    m_tracer.MarkCapacityChange(change.dataRate.GetBitRate());
+
+    if (m_nextChange < m_changes.size())
+        Simulator::Schedule(m_changes[m_nextChange].time - Simulator::Now(),
+                            &LinkController::ApplyNextChange,
+                            this);
+}
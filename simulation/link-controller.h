@@ -0,0 +1,74 @@
+#ifndef P2P_SIMULATION_LINK_CONTROLLER_H
+#define P2P_SIMULATION_LINK_CONTROLLER_H
+
+#include "configuration.h"
+#include "tracer.h"
+
+#include "ns3/core-module.h"
+#include "ns3/data-rate.h"
+#include "ns3/net-device-container.h"
+
+using namespace ns3;
+
+/**
+ * @brief LinkController class.
+ * It changes the data rate and the delay of the receiver link during the simulation, following
+ * the piecewise schedule in link_schedule or the capacity trace in link_trace.
+ * Only the next change is scheduled at any time: each change schedules the following one, so
+ * even a long trace costs a single pending event.
+ * Each capacity change is reported to the tracer, which measures the time the flows take to
+ * reconverge to the new capacity.
+ */
+class LinkController
+{
+  public:
+    /**
+     * @brief LinkController constructor.
+     * It reads the schedule or the trace of the changes.
+     * @param conf simulation configuration.
+     * @param tracer tracer notified of each capacity change.
+     */
+    LinkController(const Configuration& conf, Tracer& tracer);
+
+    /**
+     * @brief Schedule the first change of the link, if there is any.
+     * @param devices devices of the link to control.
+     */
+    void Install(const NetDeviceContainer& devices);
+
+  private:
+    /**
+     * @brief Change of the link at a given time.
+     */
+    struct LinkChange
+    {
+        Time time;         //!< Time of the change.
+        DataRate dataRate; //!< New data rate.
+        Time delay;        //!< New delay, negative to keep the current one.
+    };
+
+    /**
+     * @brief Parse a single change.
+     * Aborts if the time is not a non negative number, or if the data rate or the delay are
+     * invalid.
+     * @param time time of the change (s).
+     * @param dataRate new data rate, e.g. "5Mbps".
+     * @param delay new delay, e.g. "20ms", empty to keep the current one.
+     * @return parsed change.
+     */
+    static LinkChange ParseChange(const std::string& time,
+                                  const std::string& dataRate,
+                                  const std::string& delay);
+    /**
+     * @brief Apply the next change and schedule the following one.
+     */
+    void ApplyNextChange();
+
+  private:
+    Tracer& m_tracer;                  //!< Tracer notified of the capacity changes
+    NetDeviceContainer m_devices;      //!< Devices of the controlled link
+    std::vector<LinkChange> m_changes; //!< Changes of the link, sorted by time
+    std::size_t m_nextChange;          //!< Index of the next change to apply
+};
+
+#endif /* P2P_SIMULATION_LINK_CONTROLLER_H */
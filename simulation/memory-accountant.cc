@@ -0,0 +1,162 @@
+#include "memory-accountant.h"
+
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/queue.h"
+#include "ns3/tcp-socket-base.h"
+
+#include <fstream>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("MemoryAccountant");
+
+/// Estimated size of a Packet object with its headers, tags and buffer, without the payload
+static const uint64_t PACKET_OVERHEAD_BYTES = 256;
+
+MemoryAccountant::MemoryAccountant(const Configuration& conf, const Tracer& tracer)
+    : m_conf(conf),
+      m_tracer(tracer),
+      m_budgetExceeded(false)
+{
+}
+
+void
+MemoryAccountant::Start(const NetDeviceContainer& devices, const QueueDiscContainer& queueDiscs)
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_conf.memory_accounting && m_conf.memory_budget_mb == 0)
+        return;
+    NS_ABORT_MSG_IF(m_conf.memory_interval <= 0, "The memory interval must be positive");
+
+    m_devices = devices;
+    m_queueDiscs = queueDiscs;
+    Simulator::Schedule(Seconds(0), &MemoryAccountant::Sample, this);
+}
+
+void
+MemoryAccountant::Sample()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_current = MemoryBreakdown();
+    Config::MatchContainer sockets =
+        Config::LookupMatches("/NodeList/*/$ns3::TcpL4Protocol/SocketList/*");
+    for (uint32_t i = 0; i < sockets.GetN(); i++)
+    {
+        Ptr<TcpSocketBase> socket = DynamicCast<TcpSocketBase>(sockets.Get(i));
+        if (!socket)
+            continue;
+        m_current.socketTxBuffers += socket->GetTxBuffer()->Size();
+        m_current.socketRxBuffers += socket->GetRxBuffer()->Size();
+        m_current.socketBufferLimit += m_conf.snd_buf_size + m_conf.rcv_buf_size;
+        uint32_t bytesInFlight = socket->GetTxBuffer()->BytesInFlight();
+        m_current.packetsInFlight +=
+            (bytesInFlight + m_conf.adu_bytes - 1) / m_conf.adu_bytes * PACKET_OVERHEAD_BYTES;
+    }
+    for (uint32_t i = 0; i < m_devices.GetN(); i++)
+    {
+        Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice>(m_devices.Get(i));
+        if (device)
+        {
+            Ptr<Queue<Packet>> queue = device->GetQueue();
+            m_current.deviceQueues +=
+                queue->GetNBytes() + queue->GetNPackets() * PACKET_OVERHEAD_BYTES;
+        }
+    }
+    for (uint32_t i = 0; i < m_queueDiscs.GetN(); i++)
+    {
+        Ptr<QueueDisc> queueDisc = m_queueDiscs.Get(i);
+        m_current.queueDiscs +=
+            queueDisc->GetNBytes() + queueDisc->GetNPackets() * PACKET_OVERHEAD_BYTES;
+    }
+    m_current.tracer = m_tracer.GetMemoryUsage();
+    m_current.rss = ReadRss();
+
+    uint64_t attributed = m_current.socketTxBuffers + m_current.socketRxBuffers +
+                          m_current.packetsInFlight + m_current.deviceQueues +
+                          m_current.queueDiscs + m_current.tracer;
+    m_current.other = m_current.rss > attributed ? m_current.rss - attributed : 0;
+
+    m_peak.socketTxBuffers = std::max(m_peak.socketTxBuffers, m_current.socketTxBuffers);
+    m_peak.socketRxBuffers = std::max(m_peak.socketRxBuffers, m_current.socketRxBuffers);
+    m_peak.socketBufferLimit = std::max(m_peak.socketBufferLimit, m_current.socketBufferLimit);
+    m_peak.packetsInFlight = std::max(m_peak.packetsInFlight, m_current.packetsInFlight);
+    m_peak.deviceQueues = std::max(m_peak.deviceQueues, m_current.deviceQueues);
+    m_peak.queueDiscs = std::max(m_peak.queueDiscs, m_current.queueDiscs);
+    m_peak.tracer = std::max(m_peak.tracer, m_current.tracer);
+    m_peak.other = std::max(m_peak.other, m_current.other);
+    m_peak.rss = std::max(ReadPeakRss(), m_current.rss);
+
+    if (m_conf.memory_budget_mb > 0 && m_current.rss > m_conf.memory_budget_mb * 1000000ULL)
+    {
+        NS_LOG_WARN("Memory budget exceeded, stopping the simulation");
+        m_budgetExceeded = true;
+        // With memory accounting, the report is already printed when the simulator is destroyed
+        if (!m_conf.memory_accounting)
+            PrintReport();
+        Simulator::Stop();
+        return;
+    }
+    Simulator::Schedule(Seconds(m_conf.memory_interval), &MemoryAccountant::Sample, this);
+}
+
+const MemoryBreakdown&
+MemoryAccountant::GetCurrent() const
+{
+    return m_current;
+}
+
+const MemoryBreakdown&
+MemoryAccountant::GetPeak() const
+{
+    return m_peak;
+}
+
+void
+MemoryAccountant::PrintReport() const
+{
+    std::cout << "============= Memory ============" << std::endl;
+    if (m_budgetExceeded)
+        std::cout << "Budget of " << m_conf.memory_budget_mb << " MB exceeded at "
+                  << Simulator::Now().GetSeconds() << " s, the simulation was stopped early"
+                  << std::endl;
+    std::cout << "Component\tCurrent (MB)\tPeak (MB)" << std::endl;
+    auto printRow = [](const std::string& name, uint64_t current, uint64_t peak) {
+        std::cout << name << "\t" << current / 1e6 << "\t" << peak / 1e6 << std::endl;
+    };
+    printRow("Socket send buffers", m_current.socketTxBuffers, m_peak.socketTxBuffers);
+    printRow("Socket receive buffers", m_current.socketRxBuffers, m_peak.socketRxBuffers);
+    printRow("Socket buffer limit", m_current.socketBufferLimit, m_peak.socketBufferLimit);
+    printRow("Packets in flight", m_current.packetsInFlight, m_peak.packetsInFlight);
+    printRow("Device queues", m_current.deviceQueues, m_peak.deviceQueues);
+    printRow("Queue discs", m_current.queueDiscs, m_peak.queueDiscs);
+    printRow("Tracer", m_current.tracer, m_peak.tracer);
+    printRow("Other", m_current.other, m_peak.other);
+    printRow("Resident", m_current.rss, m_peak.rss);
+    std::cout << "=================================" << std::endl;
+}
+
+uint64_t
+MemoryAccountant::ReadRss()
+{
+    // The second field of statm is the number of resident pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident))
+        return 0;
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+uint64_t
+MemoryAccountant::ReadPeakRss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        // VmHWM: <kB> kB
+        if (line.rfind("VmHWM:", 0) == 0)
+            return std::stoull(line.substr(6)) * 1024;
+    }
+    return 0;
+}
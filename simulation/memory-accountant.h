@@ -0,0 +1,96 @@
+#ifndef P2P_SIMULATION_MEMORY_ACCOUNTANT_H
+#define P2P_SIMULATION_MEMORY_ACCOUNTANT_H
+
+#include "configuration.h"
+#include "tracer.h"
+
+#include "ns3/core-module.h"
+#include "ns3/net-device-container.h"
+#include "ns3/queue-disc-container.h"
+
+using namespace ns3;
+
+/**
+ * @brief Memory used by each component of the simulation, in bytes.
+ */
+struct MemoryBreakdown
+{
+    uint64_t socketTxBuffers = 0;   //!< Data stored in the send buffers of the TCP sockets.
+    uint64_t socketRxBuffers = 0;   //!< Data stored in the receive buffers of the TCP sockets.
+    uint64_t socketBufferLimit = 0; //!< Maximum size the socket buffers are allowed to reach.
+    uint64_t packetsInFlight = 0;   //!< Estimated size of the Packet objects sent and not acked.
+    uint64_t deviceQueues = 0;      //!< Data in the queues of the devices.
+    uint64_t queueDiscs = 0;        //!< Data in the queue discs.
+    uint64_t tracer = 0;            //!< Data stored by the tracer.
+    uint64_t other = 0;             //!< Rest of the resident memory: scheduler, nodes, code, ...
+    uint64_t rss = 0;               //!< Resident memory of the process.
+};
+
+/**
+ * @brief MemoryAccountant class.
+ * It periodically measures the memory used by the main components of the simulation and keeps
+ * the peak of each one. The resident memory of the process is read from /proc, and whatever is not
+ * attributed to a component, such as the events in the scheduler, is reported as "other".
+ * If memory_budget_mb is set and the resident memory exceeds it, the simulation is stopped early
+ * and the report is printed, instead of letting the process be killed by the system.
+ */
+class MemoryAccountant
+{
+  public:
+    /**
+     * @brief MemoryAccountant constructor.
+     * @param conf simulation configuration.
+     * @param tracer tracer whose storage is accounted.
+     */
+    MemoryAccountant(const Configuration& conf, const Tracer& tracer);
+
+    /**
+     * @brief Schedule the first measurement, if memory accounting or the budget are enabled.
+     * @param devices devices whose queues are accounted.
+     * @param queueDiscs queue discs accounted.
+     */
+    void Start(const NetDeviceContainer& devices, const QueueDiscContainer& queueDiscs);
+    /**
+     * @brief Measure the memory used by each component and schedule the next measurement after
+     * memory_interval.
+     * Stops the simulation if the memory budget is exceeded, printing the report unless memory
+     * accounting prints it at the end anyway.
+     */
+    void Sample();
+    /**
+     * @brief Last measurement getter.
+     * @return memory used by each component at the last measurement.
+     */
+    const MemoryBreakdown& GetCurrent() const;
+    /**
+     * @brief Peak getter.
+     * @return highest memory used by each component over all the measurements.
+     */
+    const MemoryBreakdown& GetPeak() const;
+    /**
+     * @brief Print the last and the peak memory used by each component to the console.
+     */
+    void PrintReport() const;
+
+    /**
+     * @brief Read the resident memory of the process.
+     * @return resident memory (bytes).
+     */
+    static uint64_t ReadRss();
+    /**
+     * @brief Read the peak resident memory of the process.
+     * @return peak resident memory (bytes).
+     */
+    static uint64_t ReadPeakRss();
+
+  private:
+    const Configuration& m_conf;     //!< Configuration
+    const Tracer& m_tracer;          //!< Tracer whose storage is accounted
+    NetDeviceContainer m_devices;    //!< Devices whose queues are accounted
+    QueueDiscContainer m_queueDiscs; //!< Queue discs accounted
+    MemoryBreakdown m_current;       //!< Last measurement
+    MemoryBreakdown m_peak;          //!< Peak of each component
+    bool m_budgetExceeded;           //!< True if the simulation was stopped by the budget
+};
+
+#endif /* P2P_SIMULATION_MEMORY_ACCOUNTANT_H */
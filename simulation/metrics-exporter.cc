@@ -0,0 +1,185 @@
+#include "metrics-exporter.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("MetricsExporter");
+
+MetricsExporter::MetricsExporter(const Configuration& conf, const Tracer& tracer)
+    : m_conf(conf),
+      m_tracer(tracer),
+      m_socket(-1),
+      m_lastSimTime(0)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    if (m_socket < 0)
+        return;
+    close(m_socket);
+    unlink(m_socketPath.c_str());
+}
+
+void
+MetricsExporter::Start()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_conf.metrics_output.empty())
+        return;
+    NS_ABORT_MSG_IF(m_conf.metrics_interval <= 0, "The metrics interval must be positive");
+
+    if (m_conf.metrics_output.rfind("unix:", 0) == 0)
+    {
+        m_socketPath = m_conf.metrics_output.substr(5);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        NS_ABORT_MSG_IF(m_socketPath.size() >= sizeof(address.sun_path),
+                        "The metrics socket path is too long");
+        std::copy(m_socketPath.begin(), m_socketPath.end(), address.sun_path);
+
+        unlink(m_socketPath.c_str());
+        m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        NS_ABORT_MSG_IF(m_socket < 0 ||
+                            bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) <
+                                0 ||
+                            listen(m_socket, 8) < 0,
+                        "Cannot listen on the metrics socket " << m_socketPath);
+        // The simulation must never wait for a scraper
+        fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL) | O_NONBLOCK);
+    }
+
+    m_lastWallTime = std::chrono::steady_clock::now();
+    m_lastSimTime = Simulator::Now().GetSeconds();
+    Simulator::Schedule(Seconds(m_conf.metrics_interval), &MetricsExporter::Export, this);
+}
+
+void
+MetricsExporter::Export()
+{
+    NS_LOG_FUNCTION(this);
+
+    std::ostringstream metrics;
+    WriteMetrics(metrics);
+    if (m_socket < 0)
+        WriteToFile(metrics.str());
+    else
+        WriteToSocket(metrics.str());
+
+    Simulator::Schedule(Seconds(m_conf.metrics_interval), &MetricsExporter::Export, this);
+}
+
+void
+MetricsExporter::WriteMetrics(std::ostream& os)
+{
+    // Upper bounds of the cwnd histogram buckets (segments)
+    static const std::vector<uint32_t> cwndBuckets = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+
+    auto now = std::chrono::steady_clock::now();
+    double simTime = Simulator::Now().GetSeconds();
+    double elapsedSim = simTime - m_lastSimTime;
+    double elapsedWall = std::chrono::duration<double>(now - m_lastWallTime).count();
+
+    std::map<std::string, uint64_t> rxBytes;
+    std::map<std::string, double> throughput;
+    std::map<std::string, std::vector<uint64_t>> cwndCounts;
+    std::map<std::string, uint64_t> cwndSum;
+    const std::map<uint32_t, FlowStats>& flowStats = m_tracer.GetFlowStats();
+    for (uint32_t flow = 0; flow < GetFlowCount(m_conf); ++flow)
+    {
+        std::string variant = GetFlowVariant(m_conf, flow);
+        auto stats = flowStats.find(flow);
+        uint64_t bytes = stats == flowStats.end() ? 0 : stats->second.rxBytes;
+        rxBytes[variant] += bytes;
+        if (elapsedSim > 0)
+            throughput[variant] += (bytes - m_lastRxBytes[flow]) * 8 / elapsedSim;
+        m_lastRxBytes[flow] = bytes;
+
+        uint32_t cwnd = m_tracer.GetCurrentCwnd(flow) / m_conf.adu_bytes;
+        std::vector<uint64_t>& counts = cwndCounts[variant];
+        counts.resize(cwndBuckets.size() + 1);
+        auto bucket = std::lower_bound(cwndBuckets.begin(), cwndBuckets.end(), cwnd);
+        ++counts[bucket - cwndBuckets.begin()];
+        cwndSum[variant] += cwnd;
+    }
+
+    os << "# HELP p2p_simulated_time_seconds Current simulated time.\n"
+       << "# TYPE p2p_simulated_time_seconds gauge\n"
+       << "p2p_simulated_time_seconds " << simTime << "\n"
+       << "# HELP p2p_wallclock_rate Simulated seconds per wall-clock second since the last "
+          "export.\n"
+       << "# TYPE p2p_wallclock_rate gauge\n"
+       << "p2p_wallclock_rate " << (elapsedWall > 0 ? elapsedSim / elapsedWall : 0) << "\n";
+
+    os << "# HELP p2p_received_bytes_total Bytes received by the sink.\n"
+       << "# TYPE p2p_received_bytes_total counter\n";
+    for (const auto& [variant, bytes] : rxBytes)
+        os << "p2p_received_bytes_total{variant=\"" << variant << "\"} " << bytes << "\n";
+
+    os << "# HELP p2p_throughput_bps Aggregate throughput since the last export.\n"
+       << "# TYPE p2p_throughput_bps gauge\n";
+    for (const auto& [variant, bps] : throughput)
+        os << "p2p_throughput_bps{variant=\"" << variant << "\"} " << bps << "\n";
+
+    os << "# HELP p2p_cwnd_segments Congestion window of the flows.\n"
+       << "# TYPE p2p_cwnd_segments histogram\n";
+    for (const auto& [variant, counts] : cwndCounts)
+    {
+        uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < cwndBuckets.size(); ++i)
+        {
+            cumulative += counts[i];
+            os << "p2p_cwnd_segments_bucket{variant=\"" << variant << "\",le=\""
+               << cwndBuckets[i] << "\"} " << cumulative << "\n";
+        }
+        cumulative += counts.back();
+        os << "p2p_cwnd_segments_bucket{variant=\"" << variant << "\",le=\"+Inf\"} "
+           << cumulative << "\n"
+           << "p2p_cwnd_segments_sum{variant=\"" << variant << "\"} " << cwndSum[variant] << "\n"
+           << "p2p_cwnd_segments_count{variant=\"" << variant << "\"} " << cumulative << "\n";
+    }
+
+    os << "# HELP p2p_queue_packets Packets in the bottleneck queue.\n"
+       << "# TYPE p2p_queue_packets gauge\n"
+       << "p2p_queue_packets " << m_tracer.GetCurrentTcpQueueSize() << "\n";
+
+    m_lastWallTime = now;
+    m_lastSimTime = simTime;
+}
+
+void
+MetricsExporter::WriteToFile(const std::string& metrics) const
+{
+    // Write to a temporary file first, so that a reader never sees a partial export
+    std::string tmpFile = m_conf.metrics_output + ".tmp";
+    std::ofstream metricsFile(tmpFile);
+    metricsFile << metrics;
+    metricsFile.close();
+    if (std::rename(tmpFile.c_str(), m_conf.metrics_output.c_str()) != 0)
+        NS_LOG_WARN("Cannot write the metrics to " << m_conf.metrics_output);
+}
+
+void
+MetricsExporter::WriteToSocket(const std::string& metrics) const
+{
+    int client;
+    while ((client = accept(m_socket, nullptr, nullptr)) >= 0)
+    {
+        std::size_t written = 0;
+        while (written < metrics.size())
+        {
+            ssize_t n = send(client, metrics.data() + written, metrics.size() - written,
+                             MSG_NOSIGNAL);
+            if (n <= 0)
+                break;
+            written += n;
+        }
+        close(client);
+    }
+}
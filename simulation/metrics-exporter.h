@@ -0,0 +1,75 @@
+#ifndef P2P_SIMULATION_METRICS_EXPORTER_H
+#define P2P_SIMULATION_METRICS_EXPORTER_H
+
+#include "configuration.h"
+#include "tracer.h"
+
+#include "ns3/core-module.h"
+
+#include <chrono>
+
+using namespace ns3;
+
+/**
+ * @brief MetricsExporter class.
+ * It periodically exports the progress of the simulation in the Prometheus text format, so that a
+ * long run can be monitored while it is still going.
+ * The metrics are written to a file, replaced atomically at each export, or served on a Unix
+ * domain socket if the output starts with "unix:". Each client connected to the socket receives
+ * the next export and is then disconnected.
+ * When the output is empty the exporter is never scheduled, so it costs nothing.
+ */
+class MetricsExporter
+{
+  public:
+    /**
+     * @brief MetricsExporter constructor.
+     * @param conf simulation configuration.
+     * @param tracer tracer the metrics are read from.
+     */
+    MetricsExporter(const Configuration& conf, const Tracer& tracer);
+    /**
+     * @brief MetricsExporter destructor.
+     * Closes the Unix domain socket, if any.
+     */
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Schedule the first export, if the exporter is enabled.
+     */
+    void Start();
+    /**
+     * @brief Export the metrics and schedule the next export after metrics_interval.
+     */
+    void Export();
+
+  private:
+    /**
+     * @brief Write the metrics in the Prometheus text format.
+     * @param os output stream.
+     */
+    void WriteMetrics(std::ostream& os);
+    /**
+     * @brief Write the metrics to the output file.
+     * @param metrics metrics to write.
+     */
+    void WriteToFile(const std::string& metrics) const;
+    /**
+     * @brief Send the metrics to all the clients waiting on the Unix domain socket.
+     * @param metrics metrics to send.
+     */
+    void WriteToSocket(const std::string& metrics) const;
+
+  private:
+    const Configuration& m_conf;                    //!< Configuration
+    const Tracer& m_tracer;                         //!< Tracer the metrics are read from
+    std::string m_socketPath;                       //!< Path of the Unix domain socket
+    int m_socket;                                   //!< Listening Unix domain socket
+    std::chrono::steady_clock::time_point m_lastWallTime; //!< Wall-clock time of the last export
+    double m_lastSimTime;                           //!< Simulated time of the last export (s)
+    std::map<uint32_t, uint64_t> m_lastRxBytes;     //!< Bytes received by each flow at last export
+};
+
+#endif /* P2P_SIMULATION_METRICS_EXPORTER_H */
@@ -0,0 +1,145 @@
+#include "paired-comparison.h"
+
+#include "simulation-runner.h"
+#include "statistics.h"
+
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE("PairedComparison");
+
+/**
+ * @brief Sample variance of a value of the replications.
+ * @param replications replications.
+ * @param value member of the replication to use.
+ * @return sample variance.
+ */
+static double
+SampleVariance(const std::vector<PairedReplication>& replications,
+               double PairedReplication::*value)
+{
+    if (replications.size() < 2)
+        return 0;
+    double mean = 0;
+    for (const PairedReplication& replication : replications)
+        mean += replication.*value;
+    mean /= replications.size();
+    double variance = 0;
+    for (const PairedReplication& replication : replications)
+        variance += (replication.*value - mean) * (replication.*value - mean);
+    return variance / (replications.size() - 1);
+}
+
+PairedComparison::PairedComparison(const Configuration& conf)
+    : m_conf(conf)
+{
+}
+
+void
+PairedComparison::Run()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (const auto& [variant, n] : m_conf.variant_groups)
+    {
+        NS_ABORT_MSG_IF(variant != "tahoe" && variant != "reno",
+                        "The paired comparison only supports Tahoe and Reno senders");
+    }
+    Configuration unswapped = m_conf;
+    unswapped.swap_variants = false;
+    for (uint32_t i = 0; i < m_conf.paired_runs; i++)
+    {
+        Configuration conf = m_conf;
+        conf.run = m_conf.run + i;
+        LossRecording recording;
+
+        NS_LOG_INFO("Paired replication " << conf.run << ": recording run");
+        conf.swap_variants = false;
+        conf.prefix_file_name = m_conf.prefix_file_name + "-paired-" + std::to_string(conf.run);
+        std::vector<double> original = RunSimulation(conf, recording);
+
+        NS_LOG_INFO("Paired replication " << conf.run << ": replaying run");
+        recording.replay = true;
+        conf.swap_variants = true;
+        conf.prefix_file_name += "-swapped";
+        std::vector<double> swapped = RunSimulation(conf, recording);
+
+        // Each position used Tahoe in one run and Reno in the other
+        PairedReplication replication = {conf.run, 0, 0, 0, recording.overflow};
+        for (uint32_t flow = 0; flow < original.size(); flow++)
+        {
+            bool tahoeFirst = GetFlowVariant(unswapped, flow) == "tahoe";
+            replication.tahoe += tahoeFirst ? original[flow] : swapped[flow];
+            replication.reno += tahoeFirst ? swapped[flow] : original[flow];
+        }
+        if (!original.empty())
+        {
+            replication.tahoe /= original.size();
+            replication.reno /= original.size();
+        }
+        replication.difference = replication.tahoe - replication.reno;
+        m_replications.push_back(replication);
+    }
+    PrintResults();
+}
+
+const std::vector<PairedReplication>&
+PairedComparison::GetReplications() const
+{
+    return m_replications;
+}
+
+void
+PairedComparison::PrintResults() const
+{
+    const std::size_t n = m_replications.size();
+    double tahoe = 0, reno = 0, difference = 0;
+    std::cout << "======= Paired comparison =======" << std::endl;
+    for (const PairedReplication& replication : m_replications)
+    {
+        std::cout << "Run: " << replication.run << "\tTahoe (Mbps): " << replication.tahoe
+                  << "\tReno (Mbps): " << replication.reno
+                  << "\tDifference (Mbps): " << replication.difference;
+        if (replication.unpaired > 0)
+            std::cout << "\tUnpaired packets: " << replication.unpaired;
+        std::cout << std::endl;
+        tahoe += replication.tahoe;
+        reno += replication.reno;
+        difference += replication.difference;
+    }
+    if (n == 0)
+        return;
+    tahoe /= n;
+    reno /= n;
+    difference /= n;
+
+    double pairedVariance = SampleVariance(m_replications, &PairedReplication::difference);
+    // Variance of the difference if the two variants had been simulated in independent runs
+    double independentVariance = SampleVariance(m_replications, &PairedReplication::tahoe) +
+                                 SampleVariance(m_replications, &PairedReplication::reno);
+    double halfWidth = StudentT95(n - 1) * std::sqrt(pairedVariance / n);
+
+    std::cout << "Tahoe (Mbps): " << tahoe << "\tReno (Mbps): " << reno << std::endl;
+    std::cout << "Tahoe - Reno (Mbps): " << difference << " +- " << halfWidth
+              << " (95% CI, " << n << " replications)" << std::endl;
+    if (pairedVariance > 0)
+        std::cout << "Variance reduction over independent runs: "
+                  << independentVariance / pairedVariance << "x" << std::endl;
+    std::cout << "=================================" << std::endl;
+}
+
+std::vector<double>
+PairedComparison::RunSimulation(const Configuration& conf, LossRecording& recording)
+{
+    SimulationRunner runner;
+    SimulationRun run = runner.Run(conf, &recording);
+
+    std::vector<double> throughputs(GetFlowCount(conf), 0);
+    for (const auto& [nodeId, stats] : run.result.flowStats)
+    {
+        double endTime =
+            stats.completionTime >= 0 ? stats.completionTime : run.result.endTime;
+        if (nodeId < throughputs.size() && stats.startTime >= 0 && endTime > stats.startTime)
+            throughputs[nodeId] = stats.rxBytes * 8 / (endTime - stats.startTime) / 1e6;
+    }
+    return throughputs;
+}
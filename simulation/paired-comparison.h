@@ -0,0 +1,74 @@
+#ifndef P2P_SIMULATION_PAIRED_COMPARISON_H
+#define P2P_SIMULATION_PAIRED_COMPARISON_H
+
+#include "configuration.h"
+#include "error-models.h"
+#include "tracer.h"
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/**
+ * @brief Result of a single paired replication.
+ * Each sender position is run once with Tahoe and once with Reno, with the same losses.
+ */
+struct PairedReplication
+{
+    uint32_t run;         //!< Run id of the replication.
+    double tahoe;         //!< Mean throughput of the positions when using Tahoe (Mbps).
+    double reno;          //!< Mean throughput of the positions when using Reno (Mbps).
+    double difference;    //!< Paired difference, tahoe - reno (Mbps).
+    uint64_t unpaired;    //!< Packets of the swapped run past the end of the recorded losses.
+};
+
+/**
+ * @brief PairedComparison class.
+ * It compares Tahoe and Reno with common random numbers.
+ * Each replication is made of two runs with the same run id: the first one records every loss
+ * decision of the error models, the second one swaps the variant of every sender and replays
+ * exactly the same decisions. Since both variants see the same losses, the difference of their
+ * throughput varies much less between replications than the one of independent runs, and fewer
+ * replications are needed for the same confidence. The packets the swapped run receives past the
+ * end of the recording get fresh losses, so they are counted as unpaired.
+ */
+class PairedComparison
+{
+  public:
+    /**
+     * @brief PairedComparison constructor.
+     * @param conf simulation configuration. The replications use the run ids from conf.run to
+     * conf.run + paired_runs - 1.
+     */
+    PairedComparison(const Configuration& conf);
+
+    /**
+     * @brief Run all the paired replications, then print the results.
+     */
+    void Run();
+    /**
+     * @brief Paired replications getter.
+     * @return result of each replication.
+     */
+    const std::vector<PairedReplication>& GetReplications() const;
+    /**
+     * @brief Print the mean paired difference and its 95% confidence interval to the console,
+     * together with the variance reduction over independent runs.
+     */
+    void PrintResults() const;
+
+  private:
+    /**
+     * @brief Run a single simulation.
+     * @param conf configuration of the simulation.
+     * @param recording losses to record or to replay.
+     * @return throughput of each flow (Mbps), indexed by the id of the sender node.
+     */
+    static std::vector<double> RunSimulation(const Configuration& conf, LossRecording& recording);
+
+  private:
+    const Configuration m_conf;                    //!< Base configuration
+    std::vector<PairedReplication> m_replications; //!< Result of each replication
+};
+
+#endif /* P2P_SIMULATION_PAIRED_COMPARISON_H */
@@ -0,0 +1,131 @@
+#include "pcap-capture.h"
+
+#include "ns3/trace-helper.h"
+
+NS_LOG_COMPONENT_DEFINE("PcapCapture");
+
+/// Size of the header of each packet in a PCAP file
+static const uint32_t PCAP_RECORD_HEADER_SIZE = 16;
+
+PcapCapture::PcapCapture(const Configuration& conf)
+    : m_conf(conf),
+      m_lossMode(conf.pcap_mode == "loss")
+{
+    NS_ABORT_MSG_IF(!m_lossMode && conf.pcap_mode != "full",
+                    "Unknown pcap mode " << conf.pcap_mode);
+}
+
+void
+PcapCapture::Install(Ptr<NetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+
+    DeviceCapture capture;
+    capture.fileName = m_conf.prefix_file_name + "-" + std::to_string(device->GetNode()->GetId()) +
+                       "-" + std::to_string(device->GetIfIndex());
+    capture.fileIndex = 0;
+    capture.fileBytes = 0;
+    capture.toWrite = 0;
+    m_devices.push_back(capture);
+
+    device->TraceConnectWithoutContext(
+        "PromiscSniffer",
+        MakeBoundCallback(&PcapCapture::SnifferTracer, this, m_devices.size() - 1));
+}
+
+void
+PcapCapture::NotifyDrop()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_lossMode)
+        return;
+
+    for (DeviceCapture& capture : m_devices)
+    {
+        for (const auto& [time, packet] : capture.history)
+        {
+            Write(capture, time, packet);
+        }
+        capture.history.clear();
+        capture.toWrite = m_conf.pcap_loss_window;
+    }
+}
+
+void
+PcapCapture::QueueDiscDropTracer(Ptr<const QueueDiscItem> item)
+{
+    NotifyDrop();
+}
+
+void
+PcapCapture::DeviceDropTracer(Ptr<const Packet> packet)
+{
+    NotifyDrop();
+}
+
+void
+PcapCapture::SnifferTracer(PcapCapture* pcapCapture, std::size_t device, Ptr<const Packet> packet)
+{
+    DeviceCapture& capture = pcapCapture->m_devices[device];
+    if (!pcapCapture->m_lossMode)
+    {
+        pcapCapture->Write(capture, Simulator::Now(), packet);
+        return;
+    }
+
+    if (capture.toWrite > 0)
+    {
+        --capture.toWrite;
+        pcapCapture->Write(capture, Simulator::Now(), packet);
+        return;
+    }
+    if (pcapCapture->m_conf.pcap_loss_window == 0)
+        return;
+    // The device may still modify the packet after the trace, so a copy is stored
+    capture.history.emplace_back(Simulator::Now(), packet->Copy());
+    if (capture.history.size() > pcapCapture->m_conf.pcap_loss_window)
+        capture.history.pop_front();
+}
+
+void
+PcapCapture::Write(DeviceCapture& capture, Time time, Ptr<const Packet> packet)
+{
+    bool rotate =
+        capture.file &&
+        ((m_conf.pcap_rotate_bytes > 0 && capture.fileBytes >= m_conf.pcap_rotate_bytes) ||
+         (m_conf.pcap_rotate_time > 0 &&
+          time - capture.fileOpened >= Seconds(m_conf.pcap_rotate_time)));
+    if (rotate)
+    {
+        capture.file->Close();
+        capture.file = nullptr;
+        ++capture.fileIndex;
+    }
+    if (!capture.file)
+        OpenFile(capture);
+
+    capture.file->Write(time, packet);
+    uint32_t snaplen = m_conf.pcap_snaplen == 0 ? packet->GetSize() : m_conf.pcap_snaplen;
+    capture.fileBytes += PCAP_RECORD_HEADER_SIZE + std::min(packet->GetSize(), snaplen);
+}
+
+void
+PcapCapture::OpenFile(DeviceCapture& capture)
+{
+    NS_LOG_FUNCTION(this << capture.fileName << capture.fileIndex);
+
+    bool rotating = m_conf.pcap_rotate_bytes > 0 || m_conf.pcap_rotate_time > 0;
+    std::string fileName =
+        capture.fileName + (rotating ? "-" + std::to_string(capture.fileIndex) : "") + ".pcap";
+
+    PcapHelper pcapHelper;
+    capture.file = pcapHelper.CreateFile(fileName,
+                                         std::ios::out,
+                                         PcapHelper::DLT_PPP,
+                                         m_conf.pcap_snaplen == 0
+                                             ? std::numeric_limits<uint32_t>::max()
+                                             : m_conf.pcap_snaplen);
+    capture.fileBytes = 0;
+    capture.fileOpened = Simulator::Now();
+}
@@ -0,0 +1,95 @@
+#ifndef P2P_SIMULATION_PCAP_CAPTURE_H
+#define P2P_SIMULATION_PCAP_CAPTURE_H
+
+#include "configuration.h"
+
+#include "ns3/core-module.h"
+#include "ns3/net-device.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/queue-item.h"
+
+#include <deque>
+
+using namespace ns3;
+
+/**
+ * @brief PcapCapture class.
+ * It writes the packets seen by a selection of devices to PCAP files.
+ * Compared to PointToPointHelper::EnablePcapAll, it can
+ * - truncate the packets to pcap_snaplen bytes, e.g. to only keep the TCP/IP headers.
+ * - rotate the files after pcap_rotate_bytes bytes or pcap_rotate_time seconds.
+ * - in "loss" mode, only keep the pcap_loss_window packets before and after each drop.
+ */
+class PcapCapture
+{
+  public:
+    /**
+     * @brief PcapCapture constructor.
+     * @param conf simulation configuration.
+     */
+    PcapCapture(const Configuration& conf);
+
+    /**
+     * @brief Start capturing the packets seen by a device.
+     * @param device device to capture.
+     */
+    void Install(Ptr<NetDevice> device);
+    /**
+     * @brief Notify a drop.
+     * In "loss" mode, the packets recently seen by the devices are written and the following
+     * ones will be too.
+     */
+    void NotifyDrop();
+    /**
+     * @brief Trace the packets dropped by a queue disc.
+     * @param item packet dropped.
+     */
+    void QueueDiscDropTracer(Ptr<const QueueDiscItem> item);
+    /**
+     * @brief Trace the packets dropped by a device.
+     * @param packet packet dropped.
+     */
+    void DeviceDropTracer(Ptr<const Packet> packet);
+
+  private:
+    /**
+     * @brief Capture state of a single device.
+     */
+    struct DeviceCapture
+    {
+        std::string fileName;                 //!< Name of the file, without extension.
+        Ptr<PcapFileWrapper> file;            //!< Current file.
+        uint32_t fileIndex;                   //!< Index of the current file.
+        uint64_t fileBytes;                   //!< Bytes written to the current file.
+        Time fileOpened;                      //!< Time the current file was opened.
+        std::deque<std::pair<Time, Ptr<const Packet>>> history; //!< Last packets seen ("loss").
+        uint32_t toWrite;                     //!< Packets to write after the last drop ("loss").
+    };
+
+    /**
+     * @brief Trace the packets seen by a device.
+     * @param capture pcap capture.
+     * @param device index of the device in the captured devices.
+     * @param packet packet seen by the device.
+     */
+    static void SnifferTracer(PcapCapture* capture, std::size_t device, Ptr<const Packet> packet);
+    /**
+     * @brief Write a packet, rotating the file if needed.
+     * @param capture capture state of the device.
+     * @param time time the packet was seen.
+     * @param packet packet to write.
+     */
+    void Write(DeviceCapture& capture, Time time, Ptr<const Packet> packet);
+    /**
+     * @brief Open the current file of a device.
+     * @param capture capture state of the device.
+     */
+    void OpenFile(DeviceCapture& capture);
+
+  private:
+    const Configuration& m_conf;          //!< Configuration
+    const bool m_lossMode;                //!< True if the pcap_mode is "loss"
+    std::vector<DeviceCapture> m_devices; //!< Capture state of each device
+};
+
+#endif /* P2P_SIMULATION_PCAP_CAPTURE_H */
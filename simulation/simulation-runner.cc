@@ -0,0 +1,68 @@
+#include "simulation-runner.h"
+
+#include "simulator-helper.h"
+
+#include "ns3/ipv4-address-generator.h"
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("SimulationRunner");
+
+void
+SimulationRunner::ResetGlobalState()
+{
+    Config::Reset();
+}
+
+double
+SimulationRunner::GetProcessStartupTime()
+{
+    // The 22nd field of stat is the time the process started after boot, in clock ticks
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    if (!std::getline(stat, line))
+        return 0;
+    // The name of the process, in parentheses, may contain spaces
+    std::istringstream fields(line.substr(line.rfind(')') + 2));
+    std::string field;
+    for (int i = 3; i < 22; i++)
+        fields >> field;
+    unsigned long long startTicks;
+    if (!(fields >> startTicks))
+        return 0;
+
+    timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    return now.tv_sec + now.tv_nsec / 1e9 -
+           static_cast<double>(startTicks) / sysconf(_SC_CLK_TCK);
+}
+
+SimulationRun
+SimulationRunner::Run(const Configuration& conf, LossRecording* recording)
+{
+    NS_LOG_FUNCTION(this << conf.run);
+
+    auto start = std::chrono::steady_clock::now();
+    // The addresses and the random streams of the previous run are still allocated
+    Ipv4AddressGenerator::Reset();
+    RngSeedManager::ResetNextStreamIndex();
+    InitializeDefaultConfiguration(conf);
+
+    Tracer tracer(conf, GraphDataUpdateType::All);
+    SimulatorHelper simHelper(conf, tracer);
+    if (recording != nullptr)
+        simHelper.SetLossRecording(*recording);
+    simHelper.Setup();
+    auto setupEnd = std::chrono::steady_clock::now();
+    SimulationRun run;
+    run.result = simHelper.Run();
+    auto runEnd = std::chrono::steady_clock::now();
+
+    run.setupTime = std::chrono::duration<double>(setupEnd - start).count();
+    run.runTime = std::chrono::duration<double>(runEnd - setupEnd).count();
+    return run;
+}
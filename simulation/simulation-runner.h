@@ -0,0 +1,56 @@
+#ifndef P2P_SIMULATION_SIMULATION_RUNNER_H
+#define P2P_SIMULATION_SIMULATION_RUNNER_H
+
+#include "configuration.h"
+#include "error-models.h"
+#include "tracer.h"
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/**
+ * @brief Outcome of a single run of the SimulationRunner.
+ */
+struct SimulationRun
+{
+    SimulationResult result; //!< Data collected by the simulation.
+    double setupTime = 0;    //!< Wall-clock time to reset and setup the run (s).
+    double runTime = 0;      //!< Wall-clock time of the simulation itself (s).
+};
+
+/**
+ * @brief SimulationRunner class.
+ * It runs many simulations back to back in the same process, so that the process startup and the
+ * registration of the ns-3 types are only paid once.
+ * Before each run, the global state left by the previous one is reset: the addresses allocated
+ * and the random stream indexes. The nodes are already removed by Simulator::Destroy at the end of
+ * each run. The default attributes are reset by ResetGlobalState, which must be called before
+ * parsing the configuration of a run, since the command line can also set them.
+ * Runs with the same configuration give the same results, as if each one had its own process.
+ */
+class SimulationRunner
+{
+  public:
+    /**
+     * @brief Reset the default attributes and the global values to their initial value.
+     * Must be called before parsing the configuration of the next run.
+     */
+    static void ResetGlobalState();
+    /**
+     * @brief Measure the time spent starting the process, i.e. between its creation and now.
+     * It includes loading the ns-3 libraries and registering their types.
+     * @return time since the process was created (s), 0 if unknown.
+     */
+    static double GetProcessStartupTime();
+
+    /**
+     * @brief Run a single simulation.
+     * @param conf resolved configuration of the simulation.
+     * @param recording losses to record or to replay, if any.
+     * @return data and timings of the run.
+     */
+    SimulationRun Run(const Configuration& conf, LossRecording* recording = nullptr);
+};
+
+#endif /* P2P_SIMULATION_SIMULATION_RUNNER_H */
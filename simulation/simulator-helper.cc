@@ -1,12 +1,27 @@
 #include "simulator-helper.h"
 
+#include "ns3/node-list.h"
+
+#include <fstream>
+#include <sstream>
+
 NS_LOG_COMPONENT_DEFINE("SimulatorHelper");
 
 SimulatorHelper::SimulatorHelper(const Configuration& conf, Tracer& tracer)
     : m_port(9),
       m_conf(conf),
       m_isInitialized(false),
-      m_tracer(tracer)
+      m_tracer(tracer),
+      m_fctTracker(conf),
+      m_metricsExporter(conf, m_tracer),
+      m_pcapCapture(conf),
+      m_eventLog(conf),
+      m_flightRecorder(conf),
+      m_memoryAccountant(conf, m_tracer),
+      m_convergenceMonitor(conf, m_tracer),
+      m_linkController(conf, m_tracer),
+      m_lossRecording(nullptr),
+      m_nErrorModels(0)
 {
     m_ipv4Helper.SetBase("10.0.1.0", "255.255.255.0");
 }
@@ -14,6 +29,10 @@ SimulatorHelper::SimulatorHelper(const Configuration& conf, Tracer& tracer)
 void
 SimulatorHelper::Setup()
 {
+    NS_ABORT_MSG_IF(m_conf.duration <= 0 &&
+                        (m_conf.max_mbytes_to_send == 0 || m_conf.workload != "bulk"),
+                    "A duration is needed unless the bulk transfers are finite");
+
     SetupNodes();
     SetupSenderChannel();
     SetupReceiverChannel();
@@ -23,12 +42,13 @@ SimulatorHelper::Setup()
 
     SetupSenderApplications();
     SetupReceiverApplications();
+    SetupReverseTraffic();
     SetupTracing();
 
     m_isInitialized = true;
 }
 
-void
+SimulationResult
 SimulatorHelper::Run()
 {
     NS_LOG_FUNCTION(this);
@@ -36,13 +56,42 @@ SimulatorHelper::Run()
     if (!m_isInitialized)
     {
         NS_LOG_WARN("SimulatorHelper is not initialized");
-        return;
+        return SimulationResult();
     }
 
     NS_LOG_INFO("Running simulation");
-    Simulator::Stop(Seconds(m_conf.duration));
+    // Without a duration, the simulation ends when all the finite transfers are completed, or at
+    // max_duration if a flow is stuck, e.g. in RTO backoff
+    NS_ABORT_MSG_IF(m_conf.duration <= 0 && m_conf.max_duration <= 0,
+                    "The max duration must be positive");
+    Simulator::Stop(Seconds(m_conf.duration > 0 ? m_conf.duration : m_conf.max_duration));
     Simulator::Run();
+    double endTime = Simulator::Now().GetSeconds();
+    if (m_conf.duration <= 0 && !m_tracer.AllFlowsCompleted())
+        NS_LOG_WARN("Stopped at max_duration before all the flows completed");
+    for (const Ptr<TraceErrorModel>& replayModel : m_replayModels)
+        m_lossRecording->overflow += replayModel->GetOverflow();
+    if (!m_replayModels.empty() && m_lossRecording->overflow > 0)
+        NS_LOG_WARN(m_lossRecording->overflow << " packets received past the recorded losses");
+    uint64_t eventCount = Simulator::GetEventCount();
+    // The data is printed by the events scheduled on destroy, before being moved out
     Simulator::Destroy();
+    SimulationResult result = m_tracer.TakeResult(endTime);
+    result.eventCount = eventCount;
+    return result;
+}
+
+void
+SimulatorHelper::SetLossRecording(LossRecording& recording)
+{
+    NS_LOG_FUNCTION(this << recording.replay);
+    m_lossRecording = &recording;
+}
+
+const Tracer&
+SimulatorHelper::GetTracer() const
+{
+    return m_tracer;
 }
 
 void
@@ -51,9 +100,13 @@ SimulatorHelper::SetupNodes()
     NS_LOG_FUNCTION(this);
 
     NS_LOG_INFO("Create nodes");
-    m_senders.Create(m_conf.n_tcp_tahoe + m_conf.n_tcp_reno);
-    m_receivers.Create(1);
+    NS_ABORT_MSG_IF(m_conf.n_receivers == 0 || m_conf.sink_ports == 0,
+                    "At least one receiver and one sink port are needed");
+    m_senders.Create(GetFlowCount(m_conf));
+    m_receivers.Create(m_conf.n_receivers);
     m_gateway.Create(1);
+    if (m_conf.n_receivers > 1)
+        m_receiverGateway.Create(1);
 
     InternetStackHelper internet;
     internet.InstallAll();
@@ -71,22 +124,20 @@ SimulatorHelper::SetupSenderChannel()
     {
         NetDeviceContainer devices = m_s_pointToPoint.Install(m_senders.Get(i), m_gateway.Get(0));
         m_ipv4Helper.NewNetwork();
-        m_ipv4Helper.Assign(devices);
+        Ipv4InterfaceContainer interfaces = m_ipv4Helper.Assign(devices);
+        m_senderDevices.Add(devices);
+        InstallErrorModel(devices, false);
+        m_tracer.RegisterFlowAddress(interfaces.GetAddress(0), m_senders.Get(i)->GetId());
+        m_flightRecorder.RegisterFlowAddress(interfaces.GetAddress(0), m_senders.Get(i)->GetId());
     }
 
-    for (uint32_t i = 0; i < m_conf.n_tcp_tahoe; i++)
+    for (uint32_t i = 0; i < GetFlowCount(m_conf); i++)
     {
+        const TcpVariant& variant = GetTcpVariant(GetFlowVariant(m_conf, i));
         Config::Set("/NodeList/" + std::to_string(i) + "/$ns3::TcpL4Protocol/SocketType",
-                    TypeIdValue(TcpTahoe::GetTypeId()));
+                    TypeIdValue(variant.congestionOps()));
         Config::Set("/NodeList/" + std::to_string(i) + "/$ns3::TcpL4Protocol/RecoveryType",
-                    TypeIdValue(TcpTahoeLossRecovery::GetTypeId()));
-    }
-    for (uint32_t i = m_conf.n_tcp_tahoe; i < m_conf.n_tcp_tahoe + m_conf.n_tcp_reno; i++)
-    {
-        Config::Set("/NodeList/" + std::to_string(i) + "/$ns3::TcpL4Protocol/SocketType",
-                    TypeIdValue(TypeId::LookupByName("ns3::TcpLinuxReno")));
-        Config::Set("/NodeList/" + std::to_string(i) + "/$ns3::TcpL4Protocol/RecoveryType",
-                    TypeIdValue(TypeId::LookupByName("ns3::TcpClassicRecovery")));
+                    TypeIdValue(variant.recoveryOps()));
     }
 }
 
@@ -95,28 +146,148 @@ SimulatorHelper::SetupReceiverChannel()
 {
     NS_LOG_FUNCTION(this);
 
-    NS_LOG_LOGIC("Create error model");
-    Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-    Ptr<RateErrorModel> error_model = CreateObject<RateErrorModel>();
-    error_model->SetRandomVariable(uv);
-    error_model->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
-    error_model->SetRate(m_conf.error_p);
-
     NS_LOG_INFO("Create receiver channel");
     m_r_pointToPoint.SetDeviceAttribute("DataRate", StringValue(m_conf.r_bandwidth));
     m_r_pointToPoint.SetChannelAttribute("Delay", StringValue(m_conf.r_delay));
-    m_r_pointToPoint.SetDeviceAttribute("ReceiveErrorModel", PointerValue(error_model));
 
-    NetDeviceContainer devices = m_r_pointToPoint.Install(m_gateway.Get(0), m_receivers.Get(0));
+    Ptr<Node> bottleneckEnd =
+        m_conf.n_receivers > 1 ? m_receiverGateway.Get(0) : m_receivers.Get(0);
+    m_receiverDevices = m_r_pointToPoint.Install(m_gateway.Get(0), bottleneckEnd);
+    InstallErrorModel(m_receiverDevices, true);
+    m_linkController.Install(m_receiverDevices);
     m_ipv4Helper.NewNetwork();
-    m_ipv4Helper.Assign(devices);
+    m_ipv4Helper.Assign(m_receiverDevices);
 
     TrafficControlHelper tch;
     tch.SetRootQueueDisc("ns3::RedQueueDisc");
-    tch.Uninstall(devices);
-    QueueDiscContainer qDiscs = tch.Install(devices);
-    qDiscs.Get(0)->TraceConnectWithoutContext("PacketsInQueue",
-                                              MakeCallback(&Tracer::TcpQueueTracer, &m_tracer));
+    tch.Uninstall(m_receiverDevices);
+    m_queueDiscs = tch.Install(m_receiverDevices.Get(0));
+    // The ACKs of all the flows share the queue at the other end of the bottleneck
+    if (m_conf.ack_thinning)
+    {
+        TrafficControlHelper ackTch;
+        ackTch.SetRootQueueDisc(AckThinningQueueDisc::GetTypeId().GetName());
+        m_queueDiscs.Add(ackTch.Install(m_receiverDevices.Get(1)));
+    }
+    else
+    {
+        m_queueDiscs.Add(tch.Install(m_receiverDevices.Get(1)));
+    }
+    m_queueDiscs.Get(0)->TraceConnectWithoutContext(
+        "Drop",
+        MakeCallback(&Tracer::QueueDropTracer, &m_tracer));
+    m_queueDiscs.Get(1)->TraceConnectWithoutContext(
+        "DropBeforeEnqueue",
+        MakeCallback(&Tracer::ReverseQueueDropTracer, &m_tracer));
+    m_queueDiscs.Get(1)->TraceConnectWithoutContext(
+        "DropAfterDequeue",
+        MakeCallback(&Tracer::ReverseQueueDropTracer, &m_tracer));
+    if constexpr (TracingPolicy::recordQueue)
+    {
+        m_queueDiscs.Get(0)->TraceConnectWithoutContext(
+            "PacketsInQueue",
+            MakeCallback(&Tracer::TcpQueueTracer<TracingPolicy>, &m_tracer));
+    }
+    else if (m_conf.trace_mode == "sample" || !m_conf.metrics_output.empty())
+    {
+        // The samples and the live metrics still need the size of the queue
+        m_queueDiscs.Get(0)->TraceConnectWithoutContext(
+            "PacketsInQueue",
+            MakeCallback(&Tracer::QueueSizeTracer, &m_tracer));
+    }
+
+    // The receivers behind the bottleneck, each on its own network
+    if (m_conf.n_receivers > 1)
+    {
+        for (uint32_t i = 0; i < m_receivers.GetN(); i++)
+        {
+            NetDeviceContainer devices =
+                m_s_pointToPoint.Install(m_receiverGateway.Get(0), m_receivers.Get(i));
+            m_ipv4Helper.NewNetwork();
+            m_ipv4Helper.Assign(devices);
+            m_sinkDevices.Add(devices);
+        }
+    }
+}
+
+Ptr<ErrorModel>
+SimulatorHelper::CreateErrorModel()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_conf.error_model == "gilbert-elliott")
+    {
+        Ptr<GilbertElliottErrorModel> errorModel = CreateObject<GilbertElliottErrorModel>();
+        errorModel->SetTransitionProbabilities(m_conf.ge_p_good_bad, m_conf.ge_p_bad_good);
+        errorModel->SetLossProbabilities(m_conf.ge_loss_good, m_conf.ge_loss_bad);
+        return errorModel;
+    }
+    if (m_conf.error_model == "trace")
+    {
+        if (!m_lossTrace)
+            m_lossTrace = TraceErrorModel::LoadTrace(m_conf.error_trace);
+        Ptr<TraceErrorModel> errorModel = CreateObject<TraceErrorModel>();
+        errorModel->SetTrace(m_lossTrace);
+        errorModel->SetLoop(m_conf.error_trace_loop);
+        return errorModel;
+    }
+    NS_ABORT_MSG_IF(m_conf.error_model != "rate", "Unknown error model " << m_conf.error_model);
+
+    Ptr<RateErrorModel> errorModel = CreateObject<RateErrorModel>();
+    errorModel->SetRandomVariable(CreateObject<UniformRandomVariable>());
+    errorModel->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
+    errorModel->SetRate(m_conf.error_p);
+    return errorModel;
+}
+
+void
+SimulatorHelper::InstallErrorModel(const NetDeviceContainer& devices, bool isReceiverLink)
+{
+    NS_LOG_FUNCTION(this << isReceiverLink);
+
+    NS_ABORT_MSG_IF(m_conf.error_links != "receiver" && m_conf.error_links != "senders" &&
+                        m_conf.error_links != "all",
+                    "Unknown error links " << m_conf.error_links);
+    if (m_conf.error_links != "all" && (m_conf.error_links == "receiver") != isReceiverLink)
+        return;
+
+    NS_LOG_LOGIC("Create error model");
+    for (uint32_t i = 0; i < devices.GetN(); i++)
+    {
+        Ptr<NetDevice> device = devices.Get(i);
+        Ptr<ErrorModel> errorModel;
+        if (m_lossRecording == nullptr)
+        {
+            errorModel = CreateErrorModel();
+        }
+        else if (m_lossRecording->replay)
+        {
+            NS_ABORT_MSG_IF(m_nErrorModels >= m_lossRecording->devices.size(),
+                            "The loss recording does not match the topology");
+            // The model of the recording run is still created, so that it takes the same random
+            // streams: every random variable created after it (RED, start jitter, workloads, TCP
+            // variants) then gets the same stream in the two runs. It only decides the losses of
+            // the packets past the end of the recording, if the replay receives more of them
+            Ptr<TraceErrorModel> replayModel = CreateObject<TraceErrorModel>();
+            replayModel->SetFallback(CreateErrorModel());
+            replayModel->SetTrace(m_lossRecording->devices[m_nErrorModels]);
+            m_replayModels.push_back(replayModel);
+            errorModel = replayModel;
+        }
+        else
+        {
+            m_lossRecording->devices.push_back(std::make_shared<std::vector<bool>>());
+            Ptr<RecordingErrorModel> recordingModel = CreateObject<RecordingErrorModel>();
+            recordingModel->Setup(CreateErrorModel(), m_lossRecording->devices.back());
+            errorModel = recordingModel;
+        }
+        m_nErrorModels++;
+        device->SetAttribute("ReceiveErrorModel", PointerValue(errorModel));
+        device->TraceConnect("PhyRxDrop",
+                             "/NodeList/" + std::to_string(device->GetNode()->GetId()) +
+                                 "/DeviceList/" + std::to_string(device->GetIfIndex()),
+                             MakeCallback(&Tracer::LinkLossTracer, &m_tracer));
+    }
 }
 
 void
@@ -125,14 +296,125 @@ SimulatorHelper::SetupSenderApplications()
     NS_LOG_FUNCTION(this);
 
     NS_LOG_INFO("Create sender applications");
-    Ipv4Address remoteAddress = m_receivers.Get(0)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
-    BulkSendHelper source("ns3::TcpSocketFactory", InetSocketAddress(remoteAddress, m_port));
-    source.SetAttribute("SendSize", UintegerValue(m_conf.adu_bytes));
-    source.SetAttribute("MaxBytes", UintegerValue(m_conf.max_mbytes_to_send * 1000000));
-    source.SetAttribute("StartTime", TimeValue(Seconds(0)));
-    source.SetAttribute("StopTime", TimeValue(Seconds(m_conf.duration)));
+    std::vector<Time> startTimes = GetSenderStartTimes();
+    if (m_conf.workload == "poisson")
+    {
+        for (uint32_t i = 0; i < m_senders.GetN(); i++)
+        {
+            Ptr<FlowWorkloadApplication> app = CreateObject<FlowWorkloadApplication>();
+            app->Setup(m_conf,
+                       GetSinkAddress(i),
+                       m_fctTracker,
+                       GetTcpVariant(GetFlowVariant(m_conf, i)).pacing);
+            app->SetStartTime(startTimes[i]);
+            app->SetStopTime(Seconds(m_conf.duration));
+            m_senders.Get(i)->AddApplication(app);
+        }
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(m_conf.workload != "bulk", "Unknown workload " << m_conf.workload);
+
+        BulkSendHelper source("ns3::TcpSocketFactory", GetSinkAddress(0));
+        source.SetAttribute("SendSize", UintegerValue(m_conf.adu_bytes));
+        source.SetAttribute("MaxBytes", UintegerValue(m_conf.max_mbytes_to_send * 1000000));
+        source.SetAttribute("StopTime", TimeValue(Seconds(m_conf.duration)));
+
+        for (uint32_t i = 0; i < m_senders.GetN(); i++)
+        {
+            source.SetAttribute("Remote", AddressValue(GetSinkAddress(i)));
+            ApplicationContainer sourceApps = source.Install(m_senders.Get(i));
+            sourceApps.Get(0)->SetStartTime(startTimes[i]);
+        }
+    }
 
-    ApplicationContainer sourceApps = source.Install(m_senders);
+    // The socket of a sender is created when its application starts
+    for (uint32_t i = 0; i < m_senders.GetN(); i++)
+    {
+        Simulator::Schedule(startTimes[i] + NanoSeconds(1),
+                            &Tracer::MarkFlowStart,
+                            &m_tracer,
+                            m_senders.Get(i)->GetId());
+        if (m_conf.workload == "bulk" && GetTcpVariant(GetFlowVariant(m_conf, i)).pacing)
+        {
+            Simulator::Schedule(startTimes[i] + NanoSeconds(1),
+                                &SimulatorHelper::EnablePacing,
+                                this,
+                                m_senders.Get(i)->GetId());
+        }
+        if (m_conf.flight_recorder)
+        {
+            Simulator::Schedule(startTimes[i] + NanoSeconds(1),
+                                &FlightRecorder::ConnectFlow,
+                                &m_flightRecorder,
+                                m_senders.Get(i)->GetId());
+        }
+    }
+}
+
+void
+SimulatorHelper::EnablePacing(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+
+    Config::MatchContainer sockets = Config::LookupMatches(
+        "/NodeList/" + std::to_string(nodeId) + "/$ns3::TcpL4Protocol/SocketList/*");
+    for (uint32_t i = 0; i < sockets.GetN(); i++)
+    {
+        DynamicCast<TcpSocketBase>(sockets.Get(i))->SetPacingStatus(true);
+    }
+}
+
+std::vector<Time>
+SimulatorHelper::GetSenderStartTimes() const
+{
+    NS_LOG_FUNCTION(this);
+
+    std::vector<Time> startTimes(m_senders.GetN(), Seconds(0));
+    if (m_conf.start_schedule == "stagger")
+    {
+        for (uint32_t i = 0; i < startTimes.size(); i++)
+        {
+            startTimes[i] = Seconds(i * m_conf.start_stagger);
+        }
+    }
+    else if (m_conf.start_schedule == "jitter")
+    {
+        Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable>();
+        jitter->SetAttribute("Max", DoubleValue(m_conf.start_jitter));
+        for (Time& startTime : startTimes)
+        {
+            startTime = Seconds(jitter->GetValue());
+        }
+    }
+    else if (m_conf.start_schedule == "trace")
+    {
+        std::ifstream traceFile(m_conf.start_trace);
+        NS_ABORT_MSG_IF(!traceFile.is_open(), "Cannot open the start trace " << m_conf.start_trace);
+        for (Time& startTime : startTimes)
+        {
+            double seconds;
+            NS_ABORT_MSG_IF(!(traceFile >> seconds),
+                            "The start trace must have a start time for each sender");
+            startTime = Seconds(seconds);
+        }
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(m_conf.start_schedule != "none",
+                        "Unknown start schedule " << m_conf.start_schedule);
+    }
+    return startTimes;
+}
+
+InetSocketAddress
+SimulatorHelper::GetSinkAddress(uint32_t flow) const
+{
+    Ptr<Node> receiver = m_receivers.Get(flow % m_conf.n_receivers);
+    // Interface 0 is the loopback
+    Ipv4Address address = receiver->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+    uint32_t port = m_port + flow / m_conf.n_receivers % m_conf.sink_ports;
+    return InetSocketAddress(address, static_cast<uint16_t>(port));
 }
 
 void
@@ -141,18 +423,85 @@ SimulatorHelper::SetupReceiverApplications()
     NS_LOG_FUNCTION(this);
 
     NS_LOG_INFO("Create receiver applications");
-    PacketSinkHelper sink("ns3::TcpSocketFactory",
+    ApplicationContainer sinkApps;
+    for (uint32_t port = m_port; port < m_port + m_conf.sink_ports; port++)
+    {
+        InetSocketAddress local(Ipv4Address::GetAny(), static_cast<uint16_t>(port));
+        PacketSinkHelper sink("ns3::TcpSocketFactory", local);
+        sink.SetAttribute("StartTime", TimeValue(Seconds(0)));
+        sink.SetAttribute("StopTime", TimeValue(Seconds(m_conf.duration)));
+        sinkApps.Add(sink.Install(m_receivers));
+    }
+    // Each sink only accepts the connections of its own flows
+    for (uint32_t i = 0; i < sinkApps.GetN(); i++)
+    {
+        sinkApps.Get(i)->TraceConnectWithoutContext(
+            "Rx",
+            MakeCallback(&Tracer::SinkRxTracer, &m_tracer));
+        if (m_conf.workload == "poisson")
+        {
+            sinkApps.Get(i)->TraceConnectWithoutContext(
+                "Rx",
+                MakeCallback(&FlowCompletionTracker::SinkRxTracer, &m_fctTracker));
+        }
+    }
+}
+
+void
+SimulatorHelper::SetupReverseTraffic()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_conf.reverse_rate.empty())
+        return;
+    NS_LOG_INFO("Create reverse traffic");
+    NS_ABORT_MSG_IF(m_conf.duration <= 0, "The reverse traffic needs a duration");
+
+    // The traffic ends at the gateway, so it only loads the path of the ACKs
+    Ptr<Ipv4> ipv4 = m_gateway.Get(0)->GetObject<Ipv4>();
+    int32_t interface = ipv4->GetInterfaceForDevice(m_receiverDevices.Get(0));
+    InetSocketAddress remote(ipv4->GetAddress(interface, 0).GetLocal(), m_port);
+
+    OnOffHelper source("ns3::UdpSocketFactory", remote);
+    // Full size packets: the MTU without the IP and UDP headers
+    source.SetConstantRate(DataRate(m_conf.reverse_rate), m_conf.mtu_bytes - 28);
+    source.SetAttribute("StartTime", TimeValue(Seconds(0)));
+    source.SetAttribute("StopTime", TimeValue(Seconds(m_conf.duration)));
+    source.Install(m_receivers.Get(0));
+
+    PacketSinkHelper sink("ns3::UdpSocketFactory",
                           InetSocketAddress(Ipv4Address::GetAny(), m_port));
     sink.SetAttribute("StartTime", TimeValue(Seconds(0)));
     sink.SetAttribute("StopTime", TimeValue(Seconds(m_conf.duration)));
-    ApplicationContainer sinkApps = sink.Install(m_receivers);
+    sink.Install(m_gateway.Get(0));
 }
 
 void
 SimulatorHelper::SetupTracing()
 {
-    Simulator::Schedule(NanoSeconds(1), MakeCallback(&Tracer::ScheduleTracing, &m_tracer));
     Simulator::ScheduleDestroy(MakeCallback(&Tracer::PrintGraphDataToFile, &m_tracer));
+    Simulator::ScheduleDestroy(MakeCallback(&Tracer::PrintFlowStats, &m_tracer));
+    if (m_conf.goodput_interval > 0)
+        Simulator::ScheduleDestroy(MakeCallback(&Tracer::PrintSeriesToFile, &m_tracer));
+    if (m_conf.workload == "poisson")
+    {
+        Simulator::ScheduleDestroy(
+            MakeCallback(&FlowCompletionTracker::PrintResults, &m_fctTracker));
+    }
+    if (m_conf.trace_mode == "sample")
+        Simulator::Schedule(Seconds(0), &Tracer::SampleGraphData, &m_tracer);
+    m_metricsExporter.Start();
+    // The links to the receivers behind the bottleneck, if any, are included
+    NetDeviceContainer allDevices(NetDeviceContainer(m_senderDevices, m_receiverDevices),
+                                  m_sinkDevices);
+    m_memoryAccountant.Start(allDevices, m_queueDiscs);
+    if (m_conf.memory_accounting)
+        Simulator::ScheduleDestroy(
+            MakeCallback(&MemoryAccountant::PrintReport, &m_memoryAccountant));
+    m_convergenceMonitor.Start();
+    if (m_conf.early_stop)
+        Simulator::ScheduleDestroy(
+            MakeCallback(&ConvergenceMonitor::PrintResults, &m_convergenceMonitor));
 
     // Set up tracing if enabled
     if (m_conf.ascii_tracing)
@@ -161,9 +510,63 @@ SimulatorHelper::SetupTracing()
         m_s_pointToPoint.EnableAsciiAll(ascii.CreateFileStream(m_conf.prefix_file_name + ".tr"));
         m_r_pointToPoint.EnableAsciiAll(ascii.CreateFileStream(m_conf.prefix_file_name + ".tr"));
     }
+    if (m_conf.event_log)
+    {
+        for (uint32_t i = 0; i < allDevices.GetN(); i++)
+        {
+            if (m_eventLog.IsNodeLogged(allDevices.Get(i)->GetNode()->GetId()))
+                m_eventLog.Install(DynamicCast<PointToPointNetDevice>(allDevices.Get(i)));
+        }
+        Simulator::ScheduleDestroy(MakeCallback(&EventLog::Close, &m_eventLog));
+    }
     if (m_conf.pcap_tracing)
     {
-        m_s_pointToPoint.EnablePcapAll(m_conf.prefix_file_name, false);
-        m_r_pointToPoint.EnablePcapAll(m_conf.prefix_file_name, false);
+        NetDeviceContainer devices = GetPcapDevices();
+        for (uint32_t i = 0; i < devices.GetN(); i++)
+        {
+            m_pcapCapture.Install(devices.Get(i));
+        }
+        // Drops at the bottleneck, either in the queue or because of the error model
+        m_queueDiscs.Get(0)->TraceConnectWithoutContext(
+            "Drop",
+            MakeCallback(&PcapCapture::QueueDiscDropTracer, &m_pcapCapture));
+        m_receiverDevices.Get(1)->TraceConnectWithoutContext(
+            "PhyRxDrop",
+            MakeCallback(&PcapCapture::DeviceDropTracer, &m_pcapCapture));
+    }
+    if (m_conf.flight_recorder)
+    {
+        m_queueDiscs.Get(0)->TraceConnectWithoutContext(
+            "Drop",
+            MakeCallback(&FlightRecorder::QueueDiscDropTracer, &m_flightRecorder));
+    }
+}
+
+NetDeviceContainer
+SimulatorHelper::GetPcapDevices() const
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_conf.pcap_devices == "all")
+        return NetDeviceContainer(NetDeviceContainer(m_senderDevices, m_receiverDevices),
+                                  m_sinkDevices);
+    if (m_conf.pcap_devices == "bottleneck")
+        return m_receiverDevices;
+    if (m_conf.pcap_devices == "senders")
+        return m_senderDevices;
+
+    // Comma separated list of node ids
+    NetDeviceContainer devices;
+    std::istringstream nodeIds(m_conf.pcap_devices);
+    std::string nodeId;
+    while (std::getline(nodeIds, nodeId, ','))
+    {
+        Ptr<Node> node = NodeList::GetNode(std::stoul(nodeId));
+        // Device 0 is the loopback
+        for (uint32_t i = 1; i < node->GetNDevices(); i++)
+        {
+            devices.Add(node->GetDevice(i));
+        }
     }
+    return devices;
 }
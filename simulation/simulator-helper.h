@@ -1,12 +1,23 @@
 #ifndef P2P_SIMULATION_SIMULATOR_HELPER_H
 #define P2P_SIMULATION_SIMULATOR_HELPER_H
 
+#include "ack-thinning-queue-disc.h"
 #include "configuration.h"
+#include "convergence-monitor.h"
+#include "error-models.h"
+#include "event-log.h"
+#include "flight-recorder.h"
+#include "flow-workload.h"
+#include "link-controller.h"
+#include "memory-accountant.h"
+#include "metrics-exporter.h"
+#include "pcap-capture.h"
 #include "tracer.h"
 
 #include "ns3/bulk-send-helper.h"
 #include "ns3/core-module.h"
 #include "ns3/internet-module.h"
+#include "ns3/on-off-helper.h"
 #include "ns3/packet-sink-helper.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/point-to-point-net-device.h"
@@ -36,6 +47,8 @@ using namespace ns3;
  * Each sender node is connected to the gateway node with a point-to-point channel.
  * The gateway node is connected to the receiver node with a point-to-point channel.
  * Both gateway and receiver nodes use a RED queue and may drop packets.
+ * The receiver end of the bottleneck carries the ACKs of all the flows, optionally with reverse
+ * cross traffic from the receiver to the gateway, and can thin the ACKs instead of using RED.
  */
 class SimulatorHelper
 {
@@ -55,13 +68,32 @@ class SimulatorHelper
     /**
      * @brief Start the simulation.
      * Can be called only after Setup().
+     * The graphs and the summaries are still printed at the end of the simulation, but all the
+     * data collected is also returned, and the tracer is left empty.
+     * The simulation runs for the whole duration, unless early_stop is enabled and the metrics
+     * converge before, or max_mbytes_to_send is set and all the flows complete before. With
+     * max_mbytes_to_send, the duration can be 0 to run until all the flows complete, bounded by
+     * max_duration.
+     * @return data collected by the simulation.
      */
-    void Run();
+    SimulationResult Run();
+    /**
+     * @brief Record the losses of this simulation, or replay the ones recorded by another one.
+     * Must be called before Setup().
+     * @param recording recording to fill or to replay, depending on its replay flag.
+     */
+    void SetLossRecording(LossRecording& recording);
+    /**
+     * @brief Simulation tracer getter.
+     * @return tracer with the data collected by the simulation.
+     */
+    const Tracer& GetTracer() const;
 
   private:
     /**
      * @brief Creates the nodes.
-     * It creates n_flows senders, 1 receiver and 1 gateway.
+     * It creates n_flows senders, n_receivers receivers and 1 gateway, plus the router at the end
+     * of the bottleneck if there is more than one receiver.
      */
     void SetupNodes();
     /**
@@ -73,42 +105,124 @@ class SimulatorHelper
     /**
      * @brief Creates the receiver channel.
      * It creates a point-to-point channel between the gateway and the receiver.
-     * Sets the data rate and delay of the channel, as well as the error rate error_p, and the
-     * number of packets the RED queue will accept at most.
+     * Sets the data rate and delay of the channel, as well as the loss model, and the number of
+     * packets the RED queue will accept at most. With ack_thinning, the queue at the receiver end
+     * thins the ACKs instead.
+     * With more than one receiver, the channel ends at a router connected to each receiver with
+     * the same links of the senders.
      */
     void SetupReceiverChannel();
+    /**
+     * @brief Creates a new instance of the loss model selected by error_model.
+     * Each device gets its own instance, so that the state of the model is not shared between
+     * links.
+     * @return loss model.
+     */
+    Ptr<ErrorModel> CreateErrorModel();
+    /**
+     * @brief Installs the loss model on the devices of a link, if the link is in error_links.
+     * The packets lost by the devices are counted by the tracer.
+     * If a loss recording is set, the decisions of the model are recorded, or the recorded ones
+     * are replayed instead of using the model. The model is created in the replay too, so that
+     * both runs use the same random streams for everything else, and it decides the losses past
+     * the end of the recording.
+     * @param devices devices of the link.
+     * @param isReceiverLink true if the link is the one between the gateway and the receiver.
+     */
+    void InstallErrorModel(const NetDeviceContainer& devices, bool isReceiverLink);
     /**
      * @brief Creates the sender applications.
      * It creates a BulkSendApplication for each sender, all sending towards the receiver.
      * Sets the packet size, the number of bytes to send, the start time and the stop time of the
      * application.
+     * If the workload is "poisson", a FlowWorkloadApplication generating short flows is used
+     * instead.
      */
     void SetupSenderApplications();
+    /**
+     * @brief Enables pacing on the sockets of a sender, for the TCP variants that set a pacing
+     * rate, like BBR.
+     * Must be scheduled right after the sender application has started, so that its socket
+     * exists. The data is only sent after the handshake, so it is all paced.
+     * @param nodeId id of the sender node.
+     */
+    void EnablePacing(uint32_t nodeId);
+    /**
+     * @brief Computes the start time of each sender application.
+     * Depending on the start_schedule, all senders start at 0 ("none"), one start_stagger after
+     * the other ("stagger"), at a uniform random time in [0, start_jitter] ("jitter") or at the
+     * times read from the start_trace file, one per line ("trace").
+     * @return start time of each sender.
+     */
+    std::vector<Time> GetSenderStartTimes() const;
+    /**
+     * @brief Computes the address of the sink of a flow.
+     * The flows are spread round robin across the receiver nodes, then across the sink_ports.
+     * @param flow index of the flow.
+     * @return address and port of the sink.
+     */
+    InetSocketAddress GetSinkAddress(uint32_t flow) const;
     /**
      * @brief Creates the receiver applications.
-     * It creates a PacketSinkApplication for the receiver, accepting connections from all senders.
+     * It creates a PacketSinkApplication for each of the sink_ports of each receiver, accepting
+     * the connections of the senders assigned to it.
      * Sets the start time and the stop time of the application.
      */
     void SetupReceiverApplications();
+    /**
+     * @brief Creates the reverse cross traffic, if reverse_rate is set.
+     * A constant rate UDP flow of full size packets goes from the first receiver to a sink on the
+     * gateway, so it shares the receiver end of the bottleneck with the ACKs of the flows.
+     */
+    void SetupReverseTraffic();
     /**
      * @brief Enables tracing.
-     * It schedules the tracing methods used to track the trace sources.
-     * It also initializes both ascii and pcap tracing for the sender and receiver channels, if
+     * It schedules the methods printing the traced data at the end of the simulation. The trace
+     * sources of each flow are attached when its sender application starts.
+     * It starts the live metrics exporter, the memory accountant and the convergence monitor, if
      * enabled.
+     * It also initializes ascii tracing, pcap tracing and the binary event log for the sender and
+     * receiver channels and the links to the receivers, as well as the flight recorder of the
+     * bottleneck queue, if enabled.
      */
     void SetupTracing();
+    /**
+     * @brief Selects the devices to capture with pcap tracing.
+     * The pcap_devices can be "all", including the links to the receivers, "bottleneck"
+     * (gateway-receiver link), "senders" (sender-gateway links) or a comma separated list of node
+     * ids.
+     * @return devices to capture.
+     */
+    NetDeviceContainer GetPcapDevices() const;
 
   private:
-    const uint32_t m_port;               //!< Port used by the receiver application.
-    const Configuration& m_conf;         //!< Simulation configuration.
-    bool m_isInitialized;                //!< True if the simulation has been initialized.
-    Tracer m_tracer;                     //!< Simulation tracer.
-    NodeContainer m_senders;             //!< Senders nodes.
-    NodeContainer m_receivers;           //!< Receiver node.
-    NodeContainer m_gateway;             //!< Gateway node.
-    Ipv4AddressHelper m_ipv4Helper;      //!< Ipv4 address generator.
-    PointToPointHelper m_s_pointToPoint; //!< Sender channel helper.
-    PointToPointHelper m_r_pointToPoint; //!< Receiver channel helper.
+    const uint32_t m_port;                //!< First port used by the receiver applications.
+    const Configuration& m_conf;          //!< Simulation configuration.
+    bool m_isInitialized;                 //!< True if the simulation has been initialized.
+    Tracer& m_tracer;                     //!< Simulation tracer.
+    FlowCompletionTracker m_fctTracker;   //!< Flow completion time tracker.
+    MetricsExporter m_metricsExporter;    //!< Live metrics exporter.
+    NodeContainer m_senders;              //!< Senders nodes.
+    NodeContainer m_receivers;            //!< Receiver nodes.
+    NodeContainer m_gateway;              //!< Gateway node.
+    NodeContainer m_receiverGateway;      //!< Router at the end of the bottleneck, if needed.
+    Ipv4AddressHelper m_ipv4Helper;       //!< Ipv4 address generator.
+    PointToPointHelper m_s_pointToPoint;  //!< Sender channel helper.
+    PointToPointHelper m_r_pointToPoint;  //!< Receiver channel helper.
+    NetDeviceContainer m_senderDevices;   //!< Devices of the sender channels.
+    NetDeviceContainer m_receiverDevices; //!< Devices of the receiver channel.
+    NetDeviceContainer m_sinkDevices;     //!< Devices of the links to the receivers, if any.
+    QueueDiscContainer m_queueDiscs;      //!< Queue discs of the receiver channel.
+    PcapCapture m_pcapCapture;            //!< Pcap capture.
+    EventLog m_eventLog;                  //!< Binary event log.
+    FlightRecorder m_flightRecorder;      //!< In memory flight recorder.
+    MemoryAccountant m_memoryAccountant;  //!< Memory accountant.
+    ConvergenceMonitor m_convergenceMonitor; //!< Early stop convergence monitor.
+    LinkController m_linkController;      //!< Changes of the receiver link.
+    std::shared_ptr<const std::vector<bool>> m_lossTrace; //!< Loss trace replayed by the links.
+    LossRecording* m_lossRecording;       //!< Losses recorded or replayed, if any.
+    std::vector<Ptr<TraceErrorModel>> m_replayModels; //!< Loss models replaying the recording.
+    uint32_t m_nErrorModels;              //!< Number of loss models installed.
 };
 
 #endif /* P2P_SIMULATION_SIMULATOR_HELPER_H */
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+double
+StudentT95(uint32_t dof)
+{
+    static const double quantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                       2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                       2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                       2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (dof == 0)
+        return std::numeric_limits<double>::infinity();
+    if (dof <= 30)
+        return quantiles[dof - 1];
+    if (dof <= 60)
+        return 2.000;
+    if (dof <= 120)
+        return 1.980;
+    return 1.960;
+}
+
+double
+ConfidenceHalfWidth95(const std::vector<double>& samples, double& mean)
+{
+    mean = 0;
+    for (double sample : samples)
+        mean += sample;
+    if (!samples.empty())
+        mean /= samples.size();
+    if (samples.size() < 2)
+        return std::numeric_limits<double>::infinity();
+
+    double variance = 0;
+    for (double sample : samples)
+        variance += (sample - mean) * (sample - mean);
+    variance /= samples.size() - 1;
+    return StudentT95(samples.size() - 1) * std::sqrt(variance / samples.size());
+}
+
+double
+JainFairnessIndex(const std::vector<double>& allocations)
+{
+    double sum = 0, sumSquares = 0;
+    for (double allocation : allocations)
+    {
+        sum += allocation;
+        sumSquares += allocation * allocation;
+    }
+    if (sumSquares == 0)
+        return 1;
+    return sum * sum / (allocations.size() * sumSquares);
+}
+
+P2Quantile::P2Quantile(double p)
+    : m_p(p),
+      m_n(0),
+      m_heights{},
+      m_positions{1, 2, 3, 4, 5},
+      m_desired{1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5},
+      m_increments{0, p / 2, p, (1 + p) / 2, 1}
+{
+}
+
+void
+P2Quantile::Add(double x)
+{
+    if (m_n < EXACT_OBSERVATIONS)
+        m_observations.push_back(x);
+    else if (m_n == EXACT_OBSERVATIONS)
+        std::vector<double>().swap(m_observations);
+
+    // The first 5 observations are the initial heights of the markers
+    if (m_n < 5)
+    {
+        m_heights[m_n++] = x;
+        if (m_n == 5)
+            std::sort(m_heights, m_heights + 5);
+        return;
+    }
+    m_n++;
+
+    // Cell of the observation, extending the extreme markers if needed
+    int k;
+    if (x < m_heights[0])
+    {
+        m_heights[0] = x;
+        k = 0;
+    }
+    else if (x >= m_heights[4])
+    {
+        m_heights[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (x >= m_heights[k + 1])
+            k++;
+    }
+    for (int i = k + 1; i < 5; i++)
+        m_positions[i]++;
+    for (int i = 0; i < 5; i++)
+        m_desired[i] += m_increments[i];
+
+    // Move the middle markers towards their desired positions
+    for (int i = 1; i < 4; i++)
+    {
+        double d = m_desired[i] - m_positions[i];
+        if ((d >= 1 && m_positions[i + 1] - m_positions[i] > 1) ||
+            (d <= -1 && m_positions[i - 1] - m_positions[i] < -1))
+        {
+            int s = d > 0 ? 1 : -1;
+            double parabolic =
+                m_heights[i] +
+                s / (m_positions[i + 1] - m_positions[i - 1]) *
+                    ((m_positions[i] - m_positions[i - 1] + s) * (m_heights[i + 1] - m_heights[i]) /
+                         (m_positions[i + 1] - m_positions[i]) +
+                     (m_positions[i + 1] - m_positions[i] - s) * (m_heights[i] - m_heights[i - 1]) /
+                         (m_positions[i] - m_positions[i - 1]));
+            if (m_heights[i - 1] < parabolic && parabolic < m_heights[i + 1])
+                m_heights[i] = parabolic;
+            else
+                m_heights[i] += s * (m_heights[i + s] - m_heights[i]) /
+                                (m_positions[i + s] - m_positions[i]);
+            m_positions[i] += s;
+        }
+    }
+}
+
+double
+P2Quantile::Get() const
+{
+    if (m_n == 0)
+        return 0;
+    if (m_n > EXACT_OBSERVATIONS)
+        return m_heights[2];
+    // Few observations: exact quantile, interpolated between the two closest sorted ones
+    std::vector<double> sorted = m_observations;
+    std::sort(sorted.begin(), sorted.end());
+    double position = m_p * (sorted.size() - 1);
+    std::size_t below = static_cast<std::size_t>(position);
+    if (below + 1 >= sorted.size())
+        return sorted.back();
+    return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
@@ -0,0 +1,70 @@
+#ifndef P2P_SIMULATION_STATISTICS_H
+#define P2P_SIMULATION_STATISTICS_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Two-sided 95% quantile of the Student's t distribution.
+ * @param dof degrees of freedom.
+ * @return quantile, infinite if dof is 0.
+ */
+double StudentT95(uint32_t dof);
+
+/**
+ * @brief Half width of the 95% confidence interval of the mean of independent samples.
+ * @param samples samples.
+ * @param mean output parameter, mean of the samples.
+ * @return half width of the confidence interval, infinite if there are less than 2 samples.
+ */
+double ConfidenceHalfWidth95(const std::vector<double>& samples, double& mean);
+
+/**
+ * @brief Jain's fairness index of a set of allocations, (sum x)^2 / (n * sum x^2).
+ * @param allocations allocations, e.g. the throughput of each flow.
+ * @return index between 1/n (one flow gets everything) and 1 (equal shares), 1 if all are 0.
+ */
+double JainFairnessIndex(const std::vector<double>& allocations);
+
+/**
+ * @brief Streaming estimator of a quantile with the P-square algorithm (Jain and Chlamtac).
+ * It keeps 5 markers whose heights are adjusted with a piecewise parabolic prediction as the
+ * observations arrive, so the memory is constant and the observations are not stored.
+ * P-square is biased with few observations, so the first EXACT_OBSERVATIONS are also kept and,
+ * until there are more, the exact quantile is returned.
+ */
+class P2Quantile
+{
+  public:
+    /// Observations kept to compute the exact quantile
+    static const uint32_t EXACT_OBSERVATIONS = 100;
+
+    /**
+     * @brief P2Quantile constructor.
+     * @param p quantile to estimate, in (0, 1).
+     */
+    explicit P2Quantile(double p = 0.5);
+
+    /**
+     * @brief Add an observation.
+     * @param x observation.
+     */
+    void Add(double x);
+    /**
+     * @brief Current estimate of the quantile.
+     * @return estimate, exact up to EXACT_OBSERVATIONS observations, interpolating between the
+     * two closest ones, 0 if there are none.
+     */
+    double Get() const;
+
+  private:
+    double m_p;                         //!< Quantile to estimate
+    uint64_t m_n;                       //!< Observations added
+    double m_heights[5];                //!< Heights of the markers
+    double m_positions[5];              //!< Actual positions of the markers
+    double m_desired[5];                //!< Desired positions of the markers
+    double m_increments[5];             //!< Increment of the desired positions at each observation
+    std::vector<double> m_observations; //!< Observations, until EXACT_OBSERVATIONS are exceeded
+};
+
+#endif /* P2P_SIMULATION_STATISTICS_H */
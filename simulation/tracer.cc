@@ -1,7 +1,17 @@
 #include "tracer.h"
 
+#include "ack-thinning-queue-disc.h"
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 NS_LOG_COMPONENT_DEFINE("Tracer");
 
+/// Consecutive windows within the tolerance needed to consider the flows reconverged
+static const uint32_t RECONVERGENCE_WINDOWS = 3;
+
 inline GraphDataUpdateType
 operator|(const GraphDataUpdateType& lhs, const GraphDataUpdateType& rhs)
 {
@@ -9,33 +19,76 @@ operator|(const GraphDataUpdateType& lhs, const GraphDataUpdateType& rhs)
 }
 
 Tracer::Tracer(const Configuration& conf)
-    : m_conf(conf),
-      m_updateType(GraphDataUpdateType::All)
+    : Tracer(conf, GraphDataUpdateType::All)
 {
 }
 
 Tracer::Tracer(const Configuration& conf, const GraphDataUpdateType updateType)
     : m_conf(conf),
-      m_updateType(updateType)
+      m_sampling(conf.trace_mode == "sample"),
+      // When sampling, no point is added to the graph when a trace source changes
+      m_updateType(m_sampling ? GraphDataUpdateType::None : updateType),
+      m_tcpQueueSize(0),
+      m_nCompletedFlows(0),
+      m_queueDrops(0),
+      m_reverseQueueDrops(0),
+      m_thinnedAcks(0),
+      m_totalRxBytes(0),
+      m_windowRxBytes(0),
+      m_reconvergedWindows(0),
+      m_goodputInterval(Seconds(conf.goodput_interval).GetNanoSeconds())
 {
+    NS_ABORT_MSG_IF(!m_sampling && conf.trace_mode != "event",
+                    "Unknown trace mode " << conf.trace_mode);
+    NS_ABORT_MSG_IF(m_sampling && !TracingPolicy::recordState,
+                    "The sample trace mode needs a tracing policy recording the cwnd");
+    NS_ABORT_MSG_IF(conf.goodput_interval < 0, "The goodput interval cannot be negative");
+    if (m_goodputInterval > 0)
+        m_goodputSeries.resize(GetFlowCount(conf));
+    if (!m_sampling)
+        return;
+
+    NS_ABORT_MSG_IF(conf.sample_interval <= 0, "The sample interval must be positive");
+    NS_ABORT_MSG_IF(conf.duration <= 0, "The sample trace mode needs a duration");
+    uint32_t nFlows = GetFlowCount(conf);
+    uint32_t capacity = static_cast<uint32_t>(conf.duration / conf.sample_interval) + 1;
+    m_bytesInFlight.assign(nFlows, 0);
+    m_sampledGraphData.nFlows = nFlows;
+    m_sampledGraphData.capacity = capacity;
+    m_sampledGraphData.time.resize(capacity);
+    m_sampledGraphData.cwnd.resize(static_cast<std::size_t>(nFlows) * capacity);
+    m_sampledGraphData.ssthresh.resize(static_cast<std::size_t>(nFlows) * capacity);
+    m_sampledGraphData.bytesInFlight.resize(static_cast<std::size_t>(nFlows) * capacity);
+    m_sampledGraphData.tcpQueueSize.resize(capacity);
 }
 
 void
-Tracer::ScheduleTracing()
+Tracer::ConnectFlowTracing(uint32_t nodeId)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << nodeId);
 
-    for (uint32_t i = 0; i < m_conf.n_tcp_tahoe + m_conf.n_tcp_reno; ++i)
+    // Signals the policy does not record are not connected at all
+    if constexpr (TracingPolicy::recordState)
     {
-        Config::Connect("/NodeList/" + std::to_string(i) +
+        Config::Connect("/NodeList/" + std::to_string(nodeId) +
                             "/$ns3::TcpL4Protocol/SocketList/0/CongestionWindow",
-                        MakeCallback(&Tracer::CwndTracer, this));
-        Config::Connect("/NodeList/" + std::to_string(i) +
+                        MakeCallback(&Tracer::CwndTracer<TracingPolicy>, this));
+        Config::Connect("/NodeList/" + std::to_string(nodeId) +
                             "/$ns3::TcpL4Protocol/SocketList/0/SlowStartThreshold",
-                        MakeCallback(&Tracer::SsThreshTracer, this));
+                        MakeCallback(&Tracer::SsThreshTracer<TracingPolicy>, this));
+    }
+    if (m_sampling)
+    {
+        Config::Connect("/NodeList/" + std::to_string(nodeId) +
+                            "/$ns3::TcpL4Protocol/SocketList/0/BytesInFlight",
+                        MakeCallback(&Tracer::BytesInFlightTracer, this));
+    }
+    if (m_conf.ack_stats)
+    {
+        Config::Connect("/NodeList/" + std::to_string(nodeId) +
+                            "/$ns3::TcpL4Protocol/SocketList/0/Rx",
+                        MakeCallback(&Tracer::AckRxTracer, this));
     }
-
-    NS_LOG_INFO("Tracing scheduled");
 }
 
 const std::map<uint32_t, std::vector<SenderGraphData>>&
@@ -50,46 +103,415 @@ Tracer::GetReceiverGraphData() const
     return m_receiverGraphData;
 }
 
+const std::map<uint32_t, FlowStats>&
+Tracer::GetFlowStats() const
+{
+    return m_flowStats;
+}
+
+const SampledGraphData&
+Tracer::GetSampledGraphData() const
+{
+    return m_sampledGraphData;
+}
+
+SimulationResult
+Tracer::TakeResult(double endTime)
+{
+    NS_LOG_FUNCTION(this << endTime);
+
+    SimulationResult result;
+    result.endTime = endTime;
+    result.queueDrops = m_queueDrops;
+    result.reverseQueueDrops = m_reverseQueueDrops;
+    result.thinnedAcks = m_thinnedAcks;
+    result.senderGraphData = std::move(m_senderGraphData);
+    result.receiverGraphData = std::move(m_receiverGraphData);
+    result.sampledGraphData = std::move(m_sampledGraphData);
+    result.flowStats = std::move(m_flowStats);
+    result.ackStats = std::move(m_ackStats);
+    result.linkLosses = std::move(m_linkLosses);
+    result.capacityChanges = std::move(m_capacityChanges);
+    result.goodputSeries = std::move(m_goodputSeries);
+    m_senderGraphData.clear();
+    m_receiverGraphData.clear();
+    m_sampledGraphData = SampledGraphData();
+    m_flowStats.clear();
+    m_ackStats.clear();
+    m_linkLosses.clear();
+    m_capacityChanges.clear();
+    if (m_goodputInterval > 0)
+        m_goodputSeries.assign(GetFlowCount(m_conf), {});
+    m_queueDrops = 0;
+    m_reverseQueueDrops = 0;
+    m_thinnedAcks = 0;
+    m_totalRxBytes = 0;
+    m_windowRxBytes = 0;
+    m_reconvergedWindows = 0;
+    m_reconvergenceEvent = EventId();
+    return result;
+}
+
+const std::vector<std::vector<uint64_t>>&
+Tracer::GetGoodputSeries() const
+{
+    return m_goodputSeries;
+}
+
+uint32_t
+Tracer::GetCurrentCwnd(uint32_t nodeId) const
+{
+    auto it = m_cwndMap.find(nodeId);
+    return it == m_cwndMap.end() ? m_conf.initial_cwnd : it->second;
+}
+
+uint32_t
+Tracer::GetCurrentTcpQueueSize() const
+{
+    return m_tcpQueueSize;
+}
+
+std::size_t
+Tracer::GetMemoryUsage() const
+{
+    // Each node of a std::map also stores three pointers and a color
+    const std::size_t mapNodeOverhead = 4 * sizeof(void*);
+    std::size_t usage = m_receiverGraphData.capacity() * sizeof(ReceiverGraphData) +
+                        m_bytesInFlight.capacity() * sizeof(uint32_t);
+    for (const auto& [nodeId, graphData] : m_senderGraphData)
+        usage += graphData.capacity() * sizeof(SenderGraphData) + mapNodeOverhead;
+    usage += (m_cwndMap.size() + m_ssThreshMap.size() + m_flowAddresses.size()) *
+             (2 * sizeof(uint32_t) + mapNodeOverhead);
+    usage += m_flowStats.size() * (sizeof(FlowStats) + mapNodeOverhead);
+    usage += m_ackStats.size() * (sizeof(AckStats) + mapNodeOverhead);
+    usage += (m_sampledGraphData.time.capacity() + m_sampledGraphData.cwnd.capacity() +
+              m_sampledGraphData.ssthresh.capacity() +
+              m_sampledGraphData.bytesInFlight.capacity() +
+              m_sampledGraphData.tcpQueueSize.capacity()) *
+             sizeof(uint32_t);
+    for (const std::vector<uint64_t>& bins : m_goodputSeries)
+        usage += bins.capacity() * sizeof(uint64_t);
+    return usage;
+}
+
+bool
+Tracer::AllFlowsCompleted() const
+{
+    return m_conf.max_mbytes_to_send > 0 && m_nCompletedFlows == GetFlowCount(m_conf);
+}
+
+void
+Tracer::RegisterFlowAddress(Ipv4Address address, uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << address << nodeId);
+    m_flowAddresses[address.Get()] = nodeId;
+}
+
+template <typename Policy>
 void
 Tracer::CwndTracer(std::string ctx, uint32_t oldval, uint32_t newval)
 {
-    NS_LOG_FUNCTION(this << ctx << oldval << newval);
+    if constexpr (Policy::logEvents)
+    {
+        NS_LOG_FUNCTION(this << ctx << oldval << newval);
+    }
+    if constexpr (!Policy::recordState)
+        return;
 
     uint32_t nodeId = GetNodeIdFromContext(ctx);
     m_cwndMap[nodeId] = newval;
-    NS_LOG_DEBUG("Node: " << nodeId << " Cwnd: " << newval);
+    if constexpr (Policy::logEvents)
+    {
+        NS_LOG_DEBUG("Node: " << nodeId << " Cwnd: " << newval);
+    }
+
+    if (newval >= (m_ssThreshMap.count(nodeId) == 0 ? m_conf.initial_ssthresh
+                                                    : m_ssThreshMap.at(nodeId)))
+        MarkSteadyState(nodeId);
 
-    if (m_updateType & GraphDataUpdateType::Cwnd)
-        UpdateGraphData(nodeId);
+    if constexpr (Policy::recordGraph)
+    {
+        if (m_updateType & GraphDataUpdateType::Cwnd)
+            UpdateGraphData(nodeId);
+    }
 }
 
+template <typename Policy>
 void
 Tracer::SsThreshTracer(std::string ctx, uint32_t oldval, uint32_t newval)
 {
-    NS_LOG_FUNCTION(this << ctx << oldval << newval);
+    if constexpr (Policy::logEvents)
+    {
+        NS_LOG_FUNCTION(this << ctx << oldval << newval);
+    }
+    if constexpr (!Policy::recordState)
+        return;
 
     if (newval == 0)
         return;
     uint32_t nodeId = GetNodeIdFromContext(ctx);
     m_ssThreshMap[nodeId] = newval;
-    NS_LOG_DEBUG("Node: " << nodeId << " SsThresh: " << newval);
+    if constexpr (Policy::logEvents)
+    {
+        NS_LOG_DEBUG("Node: " << nodeId << " SsThresh: " << newval);
+    }
 
-    if (m_updateType & GraphDataUpdateType::SsThresh)
-        UpdateGraphData(nodeId);
+    // The first ssthresh update comes from the first loss, which ends the slow start
+    MarkSteadyState(nodeId);
+
+    if constexpr (Policy::recordGraph)
+    {
+        if (m_updateType & GraphDataUpdateType::SsThresh)
+            UpdateGraphData(nodeId);
+    }
 }
 
+template <typename Policy>
 void
 Tracer::TcpQueueTracer(uint32_t oldval, uint32_t newval)
 {
-    NS_LOG_FUNCTION(this << oldval << newval);
+    if constexpr (Policy::logEvents)
+    {
+        NS_LOG_FUNCTION(this << oldval << newval);
+    }
+    if constexpr (!Policy::recordQueue)
+        return;
+
+    m_tcpQueueSize = newval;
+    if constexpr (Policy::recordGraph)
+    {
+        if (!(m_updateType & GraphDataUpdateType::QueueSize))
+            return;
+
+        ReceiverGraphData graphData = {
+            static_cast<uint32_t>(Simulator::Now().GetMilliSeconds()),
+            newval};
+        m_receiverGraphData.push_back(graphData);
+        if constexpr (Policy::logEvents)
+        {
+            NS_LOG_DEBUG("Time: " << graphData.time << " TcpQueueSize: " << graphData.tcpQueueSize);
+        }
+    }
+}
+
+template void Tracer::CwndTracer<FullTracing>(std::string, uint32_t, uint32_t);
+template void Tracer::CwndTracer<StatsTracing>(std::string, uint32_t, uint32_t);
+template void Tracer::CwndTracer<NoTracing>(std::string, uint32_t, uint32_t);
+template void Tracer::SsThreshTracer<FullTracing>(std::string, uint32_t, uint32_t);
+template void Tracer::SsThreshTracer<StatsTracing>(std::string, uint32_t, uint32_t);
+template void Tracer::SsThreshTracer<NoTracing>(std::string, uint32_t, uint32_t);
+template void Tracer::TcpQueueTracer<FullTracing>(uint32_t, uint32_t);
+template void Tracer::TcpQueueTracer<StatsTracing>(uint32_t, uint32_t);
+template void Tracer::TcpQueueTracer<NoTracing>(uint32_t, uint32_t);
+
+void
+Tracer::QueueSizeTracer(uint32_t oldval, uint32_t newval)
+{
+    m_tcpQueueSize = newval;
+}
+
+void
+Tracer::BytesInFlightTracer(std::string ctx, uint32_t oldval, uint32_t newval)
+{
+    NS_LOG_FUNCTION(this << ctx << oldval << newval);
+
+    uint32_t nodeId = GetNodeIdFromContext(ctx);
+    if (nodeId < m_bytesInFlight.size())
+        m_bytesInFlight[nodeId] = newval;
+}
+
+void
+Tracer::SampleGraphData()
+{
+    NS_LOG_FUNCTION(this);
+
+    SampledGraphData& data = m_sampledGraphData;
+    if (data.nSamples >= data.capacity)
+        return;
+
+    uint32_t i = data.nSamples++;
+    data.time[i] = static_cast<uint32_t>(Simulator::Now().GetMilliSeconds());
+    data.tcpQueueSize[i] = m_tcpQueueSize;
+    for (uint32_t flow = 0; flow < data.nFlows; ++flow)
+    {
+        std::size_t index = static_cast<std::size_t>(flow) * data.capacity + i;
+        auto cwnd = m_cwndMap.find(flow);
+        auto ssthresh = m_ssThreshMap.find(flow);
+        data.cwnd[index] = cwnd == m_cwndMap.end() ? m_conf.initial_cwnd : cwnd->second;
+        data.ssthresh[index] =
+            ssthresh == m_ssThreshMap.end() ? m_conf.initial_ssthresh : ssthresh->second;
+        data.bytesInFlight[index] = m_bytesInFlight[flow];
+    }
+
+    Simulator::Schedule(Seconds(m_conf.sample_interval), &Tracer::SampleGraphData, this);
+}
+
+void
+Tracer::SinkRxTracer(Ptr<const Packet> packet, const Address& from)
+{
+    NS_LOG_FUNCTION(this << packet << from);
+
+    auto it = m_flowAddresses.find(InetSocketAddress::ConvertFrom(from).GetIpv4().Get());
+    if (it == m_flowAddresses.end())
+        return;
+
+    FlowStats& stats = m_flowStats[it->second];
+    stats.rxBytes += packet->GetSize();
+    m_totalRxBytes += packet->GetSize();
+    if (stats.steadyStateTime >= 0)
+        stats.steadyRxBytes += packet->GetSize();
+    if (m_goodputInterval > 0 && it->second < m_goodputSeries.size())
+    {
+        // The bins grow with the simulation, so no duration is needed
+        std::vector<uint64_t>& bins = m_goodputSeries[it->second];
+        std::size_t bin = Simulator::Now().GetNanoSeconds() / m_goodputInterval;
+        if (bin >= bins.size())
+            bins.resize(bin + 1, 0);
+        bins[bin] += packet->GetSize();
+    }
+
+    if (m_conf.max_mbytes_to_send == 0 || stats.completionTime >= 0 ||
+        stats.rxBytes < m_conf.max_mbytes_to_send * 1000000)
+        return;
+    stats.completionTime = Simulator::Now().GetSeconds();
+    NS_LOG_INFO("Flow of node " << it->second << " completed at " << stats.completionTime);
+    if (++m_nCompletedFlows == GetFlowCount(m_conf))
+    {
+        NS_LOG_INFO("All the flows completed, stopping the simulation");
+        Simulator::Stop();
+    }
+}
+
+void
+Tracer::QueueDropTracer(Ptr<const QueueDiscItem> item)
+{
+    NS_LOG_FUNCTION(this << item);
+    m_queueDrops++;
+}
+
+void
+Tracer::ReverseQueueDropTracer(Ptr<const QueueDiscItem> item, const char* reason)
+{
+    NS_LOG_FUNCTION(this << item << reason);
+    if (std::strcmp(reason, AckThinningQueueDisc::THINNED_ACK_DROP) == 0)
+        m_thinnedAcks++;
+    else
+        m_reverseQueueDrops++;
+}
+
+void
+Tracer::AckRxTracer(std::string ctx,
+                    Ptr<const Packet> packet,
+                    const TcpHeader& header,
+                    Ptr<const TcpSocketBase> socket)
+{
+    if (!(header.GetFlags() & TcpHeader::ACK))
+        return;
+
+    AckStats& stats = m_ackStats[GetNodeIdFromContext(ctx)];
+    double now = Simulator::Now().GetSeconds();
+    uint32_t ack = header.GetAckNumber().GetValue();
+    if (stats.acks > 0)
+    {
+        // Welford's update, stats.acks inter-arrival times after this one
+        double interArrival = now - stats.lastAckTime;
+        double delta = interArrival - stats.interArrivalMean;
+        stats.interArrivalMean += delta / stats.acks;
+        stats.interArrivalM2 += delta * (interArrival - stats.interArrivalMean);
+        stats.interArrivalMax = std::max(stats.interArrivalMax, interArrival);
+    }
+
+    bool duplicate = stats.acks > 0 && ack == stats.lastAckNumber && packet->GetSize() == 0 &&
+                     !(header.GetFlags() & (TcpHeader::SYN | TcpHeader::FIN));
+    if (duplicate)
+    {
+        stats.dupAcks++;
+        if (stats.dupAckRun++ == 0)
+            stats.dupAckBursts++;
+        stats.maxDupAckBurst = std::max(stats.maxDupAckBurst, stats.dupAckRun);
+    }
+    else
+    {
+        stats.dupAckRun = 0;
+    }
+    stats.acks++;
+    stats.lastAckNumber = ack;
+    stats.lastAckTime = now;
+}
+
+void
+Tracer::LinkLossTracer(std::string ctx, Ptr<const Packet> packet)
+{
+    NS_LOG_FUNCTION(this << ctx << packet);
+    m_linkLosses[ctx]++;
+}
+
+void
+Tracer::MarkCapacityChange(uint64_t bitRate)
+{
+    NS_LOG_FUNCTION(this << bitRate);
 
-    if (!(m_updateType & GraphDataUpdateType::QueueSize))
+    m_capacityChanges.push_back({Simulator::Now().GetSeconds(), bitRate});
+    m_windowRxBytes = m_totalRxBytes;
+    m_reconvergedWindows = 0;
+    NS_ABORT_MSG_IF(m_conf.reconvergence_window <= 0, "The reconvergence window must be positive");
+    // The first window starts at the change, even if a check of the previous one is pending
+    m_reconvergenceEvent.Cancel();
+    m_reconvergenceEvent = Simulator::Schedule(Seconds(m_conf.reconvergence_window),
+                                               &Tracer::CheckReconvergence,
+                                               this);
+}
+
+void
+Tracer::CheckReconvergence()
+{
+    NS_LOG_FUNCTION(this);
+
+    CapacityChange& change = m_capacityChanges.back();
+    double throughput = (m_totalRxBytes - m_windowRxBytes) * 8.0 / m_conf.reconvergence_window;
+    m_windowRxBytes = m_totalRxBytes;
+    // Goodput allowed by the capacity, without the IP, TCP and PPP headers
+    double target = static_cast<double>(change.bitRate) * m_conf.adu_bytes / (m_conf.mtu_bytes + 2);
+
+    if (std::abs(throughput - target) <= m_conf.reconvergence_tolerance * target)
+        m_reconvergedWindows++;
+    else
+        m_reconvergedWindows = 0;
+    if (m_reconvergedWindows >= RECONVERGENCE_WINDOWS)
+    {
+        // The flows reconverged at the start of the first window within the tolerance
+        double reconvergedAt = Simulator::Now().GetSeconds() -
+                               RECONVERGENCE_WINDOWS * m_conf.reconvergence_window;
+        change.reconvergenceTime = std::max(0.0, reconvergedAt - change.time);
+        NS_LOG_INFO("Reconverged after " << change.reconvergenceTime << " s");
         return;
+    }
+    m_reconvergenceEvent = Simulator::Schedule(Seconds(m_conf.reconvergence_window),
+                                               &Tracer::CheckReconvergence,
+                                               this);
+}
 
-    ReceiverGraphData graphData = {static_cast<uint32_t>(Simulator::Now().GetMilliSeconds()),
-                                   newval};
-    m_receiverGraphData.push_back(graphData);
-    NS_LOG_DEBUG("Time: " << graphData.time << " TcpQueueSize: " << graphData.tcpQueueSize);
+void
+Tracer::MarkFlowStart(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+
+    m_flowStats[nodeId].startTime = Simulator::Now().GetSeconds();
+    NS_LOG_DEBUG("Node: " << nodeId << " Flow started");
+    ConnectFlowTracing(nodeId);
+}
+
+void
+Tracer::MarkSteadyState(uint32_t nodeId)
+{
+    FlowStats& stats = m_flowStats[nodeId];
+    if (stats.steadyStateTime >= 0)
+        return;
+
+    stats.steadyStateTime = Simulator::Now().GetSeconds();
+    stats.steadyStateCwnd =
+        m_cwndMap.count(nodeId) == 0 ? m_conf.initial_cwnd : m_cwndMap.at(nodeId);
+    NS_LOG_DEBUG("Node: " << nodeId << " Steady state at: " << stats.steadyStateTime);
 }
 
 uint32_t
@@ -158,6 +580,37 @@ Tracer::PrintGraphDataToFile() const
         plot.AddDataset(ssthreshDataset);
     }
 
+    const SampledGraphData& data = m_sampledGraphData;
+    for (uint32_t flow = 0; flow < data.nFlows && data.nSamples > 0; ++flow)
+    {
+        Gnuplot2dDataset cwndDataset;
+        cwndDataset.SetTitle("Node " + std::to_string(flow) + " Cwnd");
+        Gnuplot2dDataset ssthreshDataset;
+        ssthreshDataset.SetTitle("Node " + std::to_string(flow) + " SsThresh");
+        Gnuplot2dDataset bytesInFlightDataset;
+        bytesInFlightDataset.SetTitle("Node " + std::to_string(flow) + " BytesInFlight");
+        for (uint32_t i = 0; i < data.nSamples; ++i)
+        {
+            std::size_t index = static_cast<std::size_t>(flow) * data.capacity + i;
+            cwndDataset.Add(data.time[i], data.cwnd[index] / m_conf.adu_bytes);
+            ssthreshDataset.Add(data.time[i], data.ssthresh[index] / m_conf.adu_bytes);
+            bytesInFlightDataset.Add(data.time[i], data.bytesInFlight[index] / m_conf.adu_bytes);
+        }
+        plot.AddDataset(cwndDataset);
+        plot.AddDataset(ssthreshDataset);
+        plot.AddDataset(bytesInFlightDataset);
+    }
+    if (data.nSamples > 0)
+    {
+        Gnuplot2dDataset receiverDataset;
+        receiverDataset.SetTitle("Queue Size");
+        for (uint32_t i = 0; i < data.nSamples; ++i)
+        {
+            receiverDataset.Add(data.time[i], data.tcpQueueSize[i]);
+        }
+        plot.AddDataset(receiverDataset);
+    }
+
     if (!m_receiverGraphData.empty())
     {
         Gnuplot2dDataset receiverDataset;
@@ -169,7 +622,225 @@ Tracer::PrintGraphDataToFile() const
         plot.AddDataset(receiverDataset);
     }
 
+    Gnuplot2dDataset startDataset;
+    startDataset.SetTitle("Flow start");
+    startDataset.SetStyle(Gnuplot2dDataset::POINTS);
+    Gnuplot2dDataset steadyStateDataset;
+    steadyStateDataset.SetTitle("Steady state");
+    steadyStateDataset.SetStyle(Gnuplot2dDataset::POINTS);
+    for (const auto& [nodeId, stats] : m_flowStats)
+    {
+        if (stats.startTime >= 0)
+            startDataset.Add(stats.startTime * 1000, 0);
+        if (stats.steadyStateTime >= 0)
+            steadyStateDataset.Add(stats.steadyStateTime * 1000,
+                                   stats.steadyStateCwnd / m_conf.adu_bytes);
+    }
+    if (!m_flowStats.empty())
+    {
+        plot.AddDataset(startDataset);
+        plot.AddDataset(steadyStateDataset);
+    }
+    if (!m_capacityChanges.empty())
+    {
+        Gnuplot2dDataset capacityDataset;
+        capacityDataset.SetTitle("Capacity change");
+        capacityDataset.SetStyle(Gnuplot2dDataset::POINTS);
+        for (const CapacityChange& change : m_capacityChanges)
+            capacityDataset.Add(change.time * 1000, 0);
+        plot.AddDataset(capacityDataset);
+    }
+
     std::ofstream plotFile(m_conf.prefix_file_name + ".plt");
     plot.GenerateOutput(plotFile);
     plotFile.close();
+
+    if (m_goodputSeries.empty())
+        return;
+    Gnuplot goodputPlot(m_conf.prefix_file_name + "-goodput." + m_conf.graph_output);
+    goodputPlot.SetTitle("Goodput");
+    goodputPlot.SetTerminal(m_conf.graph_output);
+    goodputPlot.SetLegend("Time (ms)", "Goodput (Mbps)");
+    goodputPlot.SetExtra(
+        "set object 1 rectangle from screen 0,0 to screen 1,1 fillcolor rgb \"white\" behind");
+    const double interval = m_conf.goodput_interval;
+    for (uint32_t flow = 0; flow < m_goodputSeries.size(); ++flow)
+    {
+        Gnuplot2dDataset goodputDataset;
+        goodputDataset.SetTitle("Node " + std::to_string(flow) + " Goodput");
+        goodputDataset.SetStyle(Gnuplot2dDataset::LINES);
+        const std::vector<uint64_t>& bins = m_goodputSeries[flow];
+        for (std::size_t bin = 0; bin < bins.size(); ++bin)
+            goodputDataset.Add(bin * interval * 1000, bins[bin] * 8 / interval / 1e6);
+        goodputPlot.AddDataset(goodputDataset);
+    }
+    std::ofstream goodputFile(m_conf.prefix_file_name + "-goodput.plt");
+    goodputPlot.GenerateOutput(goodputFile);
+    goodputFile.close();
+}
+
+void
+Tracer::PrintSeriesToFile() const
+{
+    std::ofstream seriesFile(m_conf.prefix_file_name + "-series.csv");
+    seriesFile << "time,flow,variant,series,value" << std::endl;
+    auto printRow = [&](double time, uint32_t flow, const char* series, double value) {
+        seriesFile << time << "," << flow << "," << GetFlowVariant(m_conf, flow) << "," << series
+                   << "," << value << std::endl;
+    };
+
+    for (const auto& [nodeId, graphDataVector] : m_senderGraphData)
+    {
+        for (const auto& [time, cwnd, ssthresh] : graphDataVector)
+        {
+            printRow(time / 1000.0, nodeId, "cwnd", cwnd / m_conf.adu_bytes);
+            printRow(time / 1000.0, nodeId, "ssthresh", ssthresh / m_conf.adu_bytes);
+        }
+    }
+    const SampledGraphData& data = m_sampledGraphData;
+    for (uint32_t flow = 0; flow < data.nFlows; ++flow)
+    {
+        for (uint32_t i = 0; i < data.nSamples; ++i)
+        {
+            std::size_t index = static_cast<std::size_t>(flow) * data.capacity + i;
+            printRow(data.time[i] / 1000.0, flow, "cwnd", data.cwnd[index] / m_conf.adu_bytes);
+            printRow(data.time[i] / 1000.0,
+                     flow,
+                     "ssthresh",
+                     data.ssthresh[index] / m_conf.adu_bytes);
+        }
+    }
+    // The queue size does not belong to a flow
+    for (const auto& [time, queueSize] : m_receiverGraphData)
+        seriesFile << time / 1000.0 << ",,,queue," << queueSize << std::endl;
+    for (uint32_t i = 0; i < data.nSamples; ++i)
+        seriesFile << data.time[i] / 1000.0 << ",,,queue," << data.tcpQueueSize[i] << std::endl;
+    // Each goodput bin is reported at its start
+    for (uint32_t flow = 0; flow < m_goodputSeries.size(); ++flow)
+    {
+        const std::vector<uint64_t>& bins = m_goodputSeries[flow];
+        for (std::size_t bin = 0; bin < bins.size(); ++bin)
+        {
+            printRow(bin * m_conf.goodput_interval,
+                     flow,
+                     "goodput",
+                     bins[bin] * 8 / m_conf.goodput_interval / 1e6);
+        }
+    }
+    seriesFile.close();
+}
+
+void
+Tracer::PrintFlowStats() const
+{
+    double now = Simulator::Now().GetSeconds();
+    std::cout << "============= Flows =============" << std::endl;
+    for (const auto& [nodeId, stats] : m_flowStats)
+    {
+        std::cout << "Node: " << nodeId << "\tStart (s): " << stats.startTime
+                  << "\tSteady state (s): " << stats.steadyStateTime;
+        if (stats.startTime >= 0 && now > stats.startTime)
+            std::cout << "\tThroughput (Mbps): "
+                      << stats.rxBytes * 8 / (now - stats.startTime) / 1e6;
+        if (stats.steadyStateTime >= 0 && now > stats.steadyStateTime)
+            std::cout << "\tSteady throughput (Mbps): "
+                      << stats.steadyRxBytes * 8 / (now - stats.steadyStateTime) / 1e6;
+        if (stats.completionTime >= 0)
+            std::cout << "\tCompletion time (s): " << stats.completionTime - stats.startTime;
+        std::cout << std::endl;
+    }
+    if (m_conf.max_mbytes_to_send > 0 && !AllFlowsCompleted())
+    {
+        std::cout << "Flows not completed:";
+        for (uint32_t flow = 0; flow < GetFlowCount(m_conf); flow++)
+        {
+            auto it = m_flowStats.find(flow);
+            if (it == m_flowStats.end() || it->second.completionTime < 0)
+                std::cout << " " << flow;
+        }
+        std::cout << std::endl;
+    }
+
+    // Throughput of each flow until its completion, grouped by TCP variant
+    std::map<std::string, std::vector<double>> variantThroughputs;
+    std::vector<double> throughputs;
+    for (uint32_t flow = 0; flow < GetFlowCount(m_conf); flow++)
+    {
+        double throughput = 0;
+        auto it = m_flowStats.find(flow);
+        if (it != m_flowStats.end())
+        {
+            const FlowStats& stats = it->second;
+            double endTime = stats.completionTime >= 0 ? stats.completionTime : now;
+            if (stats.startTime >= 0 && endTime > stats.startTime)
+                throughput = stats.rxBytes * 8 / (endTime - stats.startTime) / 1e6;
+        }
+        variantThroughputs[GetFlowVariant(m_conf, flow)].push_back(throughput);
+        throughputs.push_back(throughput);
+    }
+    if (!throughputs.empty())
+    {
+        std::cout << "============ Variants ===========" << std::endl;
+        for (const auto& [variant, values] : variantThroughputs)
+        {
+            double aggregate = 0;
+            for (double value : values)
+                aggregate += value;
+            std::cout << "Variant: " << variant << "\tFlows: " << values.size()
+                      << "\tAggregate throughput (Mbps): " << aggregate
+                      << "\tPer flow (Mbps): " << aggregate / values.size()
+                      << "\tJain index: " << JainFairnessIndex(values) << std::endl;
+        }
+        std::cout << "Jain index of all the flows: " << JainFairnessIndex(throughputs) << std::endl;
+    }
+    if (!m_ackStats.empty())
+    {
+        std::cout << "============== ACKs =============" << std::endl;
+        for (const auto& [nodeId, stats] : m_ackStats)
+        {
+            double interArrivalStd =
+                stats.acks > 2 ? std::sqrt(stats.interArrivalM2 / (stats.acks - 2)) : 0;
+            std::cout << "Node: " << nodeId << "\tACKs: " << stats.acks
+                      << "\tInter-arrival (ms): " << stats.interArrivalMean * 1e3
+                      << "\tStd (ms): " << interArrivalStd * 1e3
+                      << "\tMax (ms): " << stats.interArrivalMax * 1e3
+                      << "\tDupACKs: " << stats.dupAcks << "\tBursts: " << stats.dupAckBursts
+                      << "\tMean burst: "
+                      << (stats.dupAckBursts > 0
+                              ? static_cast<double>(stats.dupAcks) / stats.dupAckBursts
+                              : 0)
+                      << "\tMax burst: " << stats.maxDupAckBurst;
+            if (nodeId < throughputs.size())
+                std::cout << "\tThroughput (Mbps): " << throughputs[nodeId];
+            std::cout << std::endl;
+        }
+        if (m_conf.ack_thinning)
+            std::cout << "ACKs thinned at the bottleneck: " << m_thinnedAcks << std::endl;
+    }
+    if (!m_linkLosses.empty() || m_queueDrops > 0 || m_reverseQueueDrops > 0)
+    {
+        std::cout << "============= Losses ============" << std::endl;
+        std::cout << "Device: bottleneck queue\tPackets dropped: " << m_queueDrops << std::endl;
+        if (m_reverseQueueDrops > 0)
+            std::cout << "Device: reverse bottleneck queue\tPackets dropped: "
+                      << m_reverseQueueDrops << std::endl;
+        for (const auto& [device, losses] : m_linkLosses)
+        {
+            std::cout << "Device: " << device << "\tPackets lost: " << losses << std::endl;
+        }
+    }
+    if (!m_capacityChanges.empty())
+    {
+        std::cout << "======= Capacity changes ========" << std::endl;
+        for (const CapacityChange& change : m_capacityChanges)
+        {
+            std::cout << "Time (s): " << change.time
+                      << "\tCapacity (Mbps): " << change.bitRate / 1e6 << "\tReconvergence (s): ";
+            if (change.reconvergenceTime >= 0)
+                std::cout << change.reconvergenceTime << std::endl;
+            else
+                std::cout << "never" << std::endl;
+        }
+    }
+    std::cout << "=================================" << std::endl;
 }
@@ -2,11 +2,17 @@
 #define P2P_SIMULATION_TRACER_H
 
 #include "configuration.h"
+#include "tracing-policy.h"
 
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
 #include "ns3/gnuplot.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/queue-item.h"
 #include "ns3/socket.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-socket-base.h"
 
 using namespace ns3;
 
@@ -54,11 +60,110 @@ struct ReceiverGraphData
     uint32_t tcpQueueSize;
 };
 
+/**
+ * @brief Graph data collected by sampling all the flows at a fixed interval.
+ * Each column is preallocated for the whole simulation, so the memory needed does not depend
+ * on the rate of the events. The per-flow columns store the samples of each flow contiguously:
+ * the value of flow f at sample i is at index f * capacity + i.
+ */
+struct SampledGraphData
+{
+    uint32_t nFlows = 0;                 //!< Number of flows sampled.
+    uint32_t capacity = 0;               //!< Maximum number of samples.
+    uint32_t nSamples = 0;               //!< Number of samples taken.
+    std::vector<uint32_t> time;          //!< Time of each sample (ms).
+    std::vector<uint32_t> cwnd;          //!< Congestion window of each flow.
+    std::vector<uint32_t> ssthresh;      //!< Slow start threshold of each flow.
+    std::vector<uint32_t> bytesInFlight; //!< Bytes in flight of each flow.
+    std::vector<uint32_t> tcpQueueSize;  //!< Size of the bottleneck queue.
+};
+
+/**
+ * @brief Statistics of a single flow.
+ * The warm-up of a flow goes from its start to the end of its first slow start, either because
+ * of a loss or because the cwnd reached the ssthresh. What follows is considered steady state.
+ */
+struct FlowStats
+{
+    double startTime = -1;        //!< Time the sender application started (s).
+    double steadyStateTime = -1;  //!< Time the flow entered the steady state (s).
+    uint32_t steadyStateCwnd = 0; //!< Congestion window when entering the steady state.
+    uint64_t rxBytes = 0;         //!< Bytes received by the sink.
+    uint64_t steadyRxBytes = 0;   //!< Bytes received by the sink during the steady state.
+    double completionTime = -1;   //!< Time the sink received all the max_mbytes_to_send (s).
+};
+
+/**
+ * @brief ACKs received by the sender of a flow.
+ * The inter-arrival time of the ACKs is the clock of the sender: delayed ACKs, ACK thinning and
+ * the queueing of the ACKs behind the reverse traffic all stretch it. A burst of duplicate ACKs is
+ * a run of consecutive ACKs with the same ack number, each of which may trigger the recovery.
+ */
+struct AckStats
+{
+    uint64_t acks = 0;             //!< ACKs received.
+    uint64_t dupAcks = 0;          //!< Duplicate ACKs received.
+    uint64_t dupAckBursts = 0;     //!< Runs of consecutive duplicate ACKs.
+    uint32_t maxDupAckBurst = 0;   //!< Longest run of duplicate ACKs.
+    uint32_t dupAckRun = 0;        //!< Duplicate ACKs in the current run.
+    uint32_t lastAckNumber = 0;    //!< Ack number of the last ACK.
+    double lastAckTime = -1;       //!< Time of the last ACK (s).
+    double interArrivalMean = 0;   //!< Mean time between two ACKs (s).
+    double interArrivalM2 = 0;     //!< Sum of the squared distances from the mean (s^2).
+    double interArrivalMax = 0;    //!< Longest time between two ACKs (s).
+};
+
+/**
+ * @brief Change of the capacity of the bottleneck, and how long the flows took to adapt to it.
+ * The flows have reconverged when the throughput received by the sink stays within
+ * reconvergence_tolerance of the goodput the new capacity allows, for RECONVERGENCE_WINDOWS
+ * consecutive windows of reconvergence_window seconds.
+ */
+struct CapacityChange
+{
+    double time;                    //!< Time of the change (s).
+    uint64_t bitRate;               //!< New capacity (bps).
+    double reconvergenceTime = -1;  //!< Time from the change to the reconvergence (s), -1: never.
+};
+
+/**
+ * @brief Data collected by a simulation.
+ * It owns all the time series and statistics of the run, and it can only be moved, so that
+ * returning it never copies the series.
+ */
+struct SimulationResult
+{
+    SimulationResult() = default;
+    SimulationResult(const SimulationResult&) = delete;
+    SimulationResult& operator=(const SimulationResult&) = delete;
+    SimulationResult(SimulationResult&&) = default;
+    SimulationResult& operator=(SimulationResult&&) = default;
+
+    double endTime = 0;             //!< Simulated time the simulation ended at (s).
+    uint64_t eventCount = 0;        //!< Events executed by the simulator.
+    uint64_t queueDrops = 0;        //!< Packets dropped by the bottleneck queue.
+    uint64_t reverseQueueDrops = 0; //!< Packets dropped by the queue on the path of the ACKs.
+    uint64_t thinnedAcks = 0;       //!< ACKs thinned by the queue on the path of the ACKs.
+    std::map<uint32_t, std::vector<SenderGraphData>>
+        senderGraphData;                            //!< Cwnd and ssthresh series of each flow.
+    std::vector<ReceiverGraphData> receiverGraphData; //!< Queue size series.
+    SampledGraphData sampledGraphData;              //!< Sampled series, in "sample" trace mode.
+    std::map<uint32_t, FlowStats> flowStats;        //!< Statistics of each flow.
+    std::map<uint32_t, AckStats> ackStats;          //!< ACKs of each flow, with ack_stats.
+    std::map<std::string, uint64_t> linkLosses;     //!< Packets lost by each device.
+    std::vector<CapacityChange> capacityChanges;    //!< Capacity changes of the bottleneck.
+    std::vector<std::vector<uint64_t>>
+        goodputSeries; //!< Bytes received from each flow in each goodput_interval.
+};
+
 /**
  * @brief Tracer class.
  * It is used to trace the simulation and aggregate the data.
  * The data will later be used to create the graphs.
  * It uses the ns3 callback system to spy on the trace sources.
+ * The per-event callbacks are templates on a tracing policy, explicitly instantiated in tracer.cc
+ * for each policy of tracing-policy.h. Only the callbacks of the TracingPolicy of the build are
+ * connected.
  */
 class Tracer
 {
@@ -85,33 +190,174 @@ class Tracer
      * @return receiver graph data.
      */
     const std::vector<ReceiverGraphData>& GetReceiverGraphData() const;
+    /**
+     * @brief Flow statistics getter.
+     * @return statistics of each flow, indexed by the id of the sender node.
+     */
+    const std::map<uint32_t, FlowStats>& GetFlowStats() const;
+    /**
+     * @brief Sampled graph data getter.
+     * Only filled when the trace_mode is "sample".
+     * @return sampled graph data.
+     */
+    const SampledGraphData& GetSampledGraphData() const;
 
     /**
-     * @brief Schedule the tracing.
-     * Since some resources are not created at the beginning of the simulation,
-     * the tracing must be scheduled to be attached after the simulation has started.
+     * @brief Move all the collected data into a SimulationResult.
+     * The tracer is left empty, so it must be called after the data has been printed.
+     * @param endTime simulated time the simulation ended at (s).
+     * @return collected data.
      */
-    void ScheduleTracing();
+    SimulationResult TakeResult(double endTime);
+
+    /**
+     * @brief Goodput series getter.
+     * Only filled when goodput_interval is set.
+     * @return bytes received by the sink from each flow in each goodput_interval.
+     */
+    const std::vector<std::vector<uint64_t>>& GetGoodputSeries() const;
+
+    /**
+     * @brief Get the last traced congestion window of a flow.
+     * @param nodeId id of the sender node.
+     * @return congestion window (bytes).
+     */
+    uint32_t GetCurrentCwnd(uint32_t nodeId) const;
+    /**
+     * @brief Get the last traced size of the queue.
+     * @return number of packets in the queue.
+     */
+    uint32_t GetCurrentTcpQueueSize() const;
+    /**
+     * @brief Get the memory used to store the traced data.
+     * @return approximate memory used (bytes).
+     */
+    std::size_t GetMemoryUsage() const;
+
+    /**
+     * @brief Check if all the flows have delivered their max_mbytes_to_send.
+     * @return true if all the flows are completed, always false if the transfers are unlimited.
+     */
+    bool AllFlowsCompleted() const;
+
+    /**
+     * @brief Associate the address of a sender with its node.
+     * Used to attribute the bytes received by the sink to the right flow.
+     * @param address address of the sender.
+     * @param nodeId id of the sender node.
+     */
+    void RegisterFlowAddress(Ipv4Address address, uint32_t nodeId);
+
+    /**
+     * @brief Attach the tracing to the socket of a single flow.
+     * @param nodeId id of the sender node.
+     */
+    void ConnectFlowTracing(uint32_t nodeId);
     /**
      * @brief Trace the congestion window.
+     * @tparam Policy tracing policy.
      * @param ctx id of the node.
      * @param oldval old congestion window value.
      * @param newval new congestion window value.
      */
+    template <typename Policy = TracingPolicy>
     void CwndTracer(std::string ctx, uint32_t oldval, uint32_t newval);
     /**
      * @brief Trace the slow start threshold.
+     * @tparam Policy tracing policy.
      * @param ctx id of the node.
      * @param oldval old slow start threshold value.
      * @param newval new slow start threshold value.
      */
+    template <typename Policy = TracingPolicy>
     void SsThreshTracer(std::string ctx, uint32_t oldval, uint32_t newval);
     /**
      * @brief Trace the queue size.
+     * @tparam Policy tracing policy.
      * @param oldval old queue size.
      * @param newval new queue size.
      */
+    template <typename Policy = TracingPolicy>
     void TcpQueueTracer(uint32_t oldval, uint32_t newval);
+    /**
+     * @brief Track the current size of the queue, without adding graph points.
+     * Connected instead of TcpQueueTracer when the policy does not record the queue, but the
+     * samples or the live metrics need its size.
+     * @param oldval old queue size.
+     * @param newval new queue size.
+     */
+    void QueueSizeTracer(uint32_t oldval, uint32_t newval);
+    /**
+     * @brief Trace the bytes in flight.
+     * Only connected when the trace_mode is "sample".
+     * @param ctx id of the node.
+     * @param oldval old bytes in flight value.
+     * @param newval new bytes in flight value.
+     */
+    void BytesInFlightTracer(std::string ctx, uint32_t oldval, uint32_t newval);
+    /**
+     * @brief Take a sample of all the flows and of the queue, then schedule the next one after
+     * sample_interval.
+     */
+    void SampleGraphData();
+    /**
+     * @brief Trace the bytes received by a sink.
+     * If goodput_interval is set, the bytes are also added to the bin of the current interval of
+     * the flow. If max_mbytes_to_send is set, a flow is completed when the sink has received all
+     * its bytes, and the simulation is stopped as soon as all the flows are completed.
+     * @param packet packet received.
+     * @param from address of the sender.
+     */
+    void SinkRxTracer(Ptr<const Packet> packet, const Address& from);
+    /**
+     * @brief Trace the packets dropped by the bottleneck queue.
+     * @param item packet dropped.
+     */
+    void QueueDropTracer(Ptr<const QueueDiscItem> item);
+    /**
+     * @brief Trace the packets dropped by the queue at the receiver end of the bottleneck, which
+     * carries the ACKs of all the flows and the reverse traffic.
+     * @param item packet dropped.
+     * @param reason reason of the drop, to tell the ACKs thinned from the overflows.
+     */
+    void ReverseQueueDropTracer(Ptr<const QueueDiscItem> item, const char* reason);
+    /**
+     * @brief Trace the segments received by a sender, to measure the timing of its ACKs.
+     * Only connected when ack_stats is enabled.
+     * @param ctx path of the socket.
+     * @param packet payload of the segment.
+     * @param header TCP header of the segment.
+     * @param socket socket of the sender.
+     */
+    void AckRxTracer(std::string ctx,
+                     Ptr<const Packet> packet,
+                     const TcpHeader& header,
+                     Ptr<const TcpSocketBase> socket);
+    /**
+     * @brief Trace the packets lost by a device because of its loss model.
+     * @param ctx path of the device.
+     * @param packet packet lost.
+     */
+    void LinkLossTracer(std::string ctx, Ptr<const Packet> packet);
+    /**
+     * @brief Mark a change of the capacity of the bottleneck and start measuring the time the
+     * flows take to reconverge. A pending check of the previous change is cancelled, and the
+     * first window starts at this change.
+     * @param bitRate new capacity (bps).
+     */
+    void MarkCapacityChange(uint64_t bitRate);
+    /**
+     * @brief Check if the throughput has reconverged to the last capacity, then schedule the next
+     * check after reconvergence_window, until it has.
+     */
+    void CheckReconvergence();
+    /**
+     * @brief Mark the start of a flow and attach the tracing to its socket.
+     * Must be scheduled right after the sender application has started, so that its socket
+     * exists. Only the first socket of the sender is traced.
+     * @param nodeId id of the sender node.
+     */
+    void MarkFlowStart(uint32_t nodeId);
     /**
      * @brief Print the aggregated data to the console.
      */
@@ -120,8 +366,27 @@ class Tracer
      * @brief Print the aggregated data to a file.
      * The file can be later be processed by gnuplot to create a .png file.
      * `gnuplot <prefix_file_name>.plot`
+     * If goodput_interval is set, the goodput of each flow is plotted in
+     * <prefix_file_name>-goodput.plt.
      */
     void PrintGraphDataToFile() const;
+    /**
+     * @brief Print the cwnd, ssthresh and goodput series of all the flows to
+     * <prefix_file_name>-series.csv, one "time,flow,variant,series,value" row for each point.
+     * The queue size series is printed too, with empty flow and variant.
+     */
+    void PrintSeriesToFile() const;
+    /**
+     * @brief Print the throughput of each flow to the console, both over the whole flow and
+     * over its steady state only, excluding the warm-up, as well as its completion time, and the
+     * flows that did not complete, if max_mbytes_to_send is set.
+     * The aggregate throughput and the Jain fairness index of each TCP variant, the packets
+     * dropped by the bottleneck queue or lost by each device with a loss model and the
+     * reconvergence time after each capacity change are printed as well. With ack_stats, the ACK
+     * inter-arrival time and the duplicate ACK bursts of each flow are printed next to its
+     * throughput.
+     */
+    void PrintFlowStats() const;
 
   protected:
     /**
@@ -135,15 +400,39 @@ class Tracer
      * @param nodeId id of the node the data belongs to.
      */
     void UpdateGraphData(uint32_t nodeId);
+    /**
+     * @brief Mark the entry of a flow in the steady state, if it has not entered it yet.
+     * @param nodeId id of the sender node.
+     */
+    void MarkSteadyState(uint32_t nodeId);
 
   private:
     const Configuration& m_conf;              //!< Configuration
+    const bool m_sampling;                      //!< True if the trace_mode is "sample"
     const GraphDataUpdateType m_updateType;     //!< Aggregation type
     std::map<uint32_t, uint32_t> m_cwndMap;     //!< Congestion window outut
     std::map<uint32_t, uint32_t> m_ssThreshMap; //!< Slow start threshold outut
+    std::vector<uint32_t> m_bytesInFlight;      //!< Bytes in flight of each flow
+    uint32_t m_tcpQueueSize;                    //!< Current size of the queue
+    uint32_t m_nCompletedFlows;                 //!< Flows that delivered all their bytes
+    uint64_t m_queueDrops;                      //!< Packets dropped by the bottleneck queue
+    uint64_t m_reverseQueueDrops;               //!< Packets dropped on the path of the ACKs
+    uint64_t m_thinnedAcks;                     //!< ACKs thinned on the path of the ACKs
+    uint64_t m_totalRxBytes;                    //!< Bytes received by the sink from all flows
+    uint64_t m_windowRxBytes;                   //!< Bytes received at the last reconvergence check
+    uint32_t m_reconvergedWindows;              //!< Consecutive windows within the tolerance
+    EventId m_reconvergenceEvent;               //!< Next reconvergence check, if any
+    int64_t m_goodputInterval;                  //!< Goodput bin width (ns), 0 if disabled
     std::map<uint32_t, std::vector<SenderGraphData>>
         m_senderGraphData;                              //!< Aggregated sender data outut
     std::vector<ReceiverGraphData> m_receiverGraphData; //!< Aggregated receiver data outut
+    std::map<uint32_t, uint32_t> m_flowAddresses;       //!< Node id of each sender address
+    std::map<uint32_t, FlowStats> m_flowStats;          //!< Statistics of each flow
+    std::map<uint32_t, AckStats> m_ackStats;            //!< ACKs received by each flow
+    SampledGraphData m_sampledGraphData;                //!< Sampled data outut
+    std::map<std::string, uint64_t> m_linkLosses;       //!< Packets lost by each device
+    std::vector<CapacityChange> m_capacityChanges;      //!< Capacity changes of the bottleneck
+    std::vector<std::vector<uint64_t>> m_goodputSeries; //!< Goodput bins of each flow (bytes)
 };
 
 #endif /* P2P_SIMULATION_TRACER_H */
\ No newline at end of file
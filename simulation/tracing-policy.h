@@ -0,0 +1,59 @@
+#ifndef P2P_SIMULATION_TRACING_POLICY_H
+#define P2P_SIMULATION_TRACING_POLICY_H
+
+/**
+ * @brief Compile-time tracing policies.
+ * A policy selects which signals the tracer records. The callbacks of the signals a policy does
+ * not record are never connected to the trace sources, and the branches and log statements
+ * inside the callbacks are removed at compile time, so an untraced build pays nothing per event.
+ * The policy of a build is chosen with the P2P_TRACING_POLICY CMake option.
+ */
+
+/**
+ * @brief Record everything: cwnd and ssthresh state, graph series, queue size and per-event logs.
+ */
+struct FullTracing
+{
+    static constexpr bool recordState = true;   //!< Track cwnd and ssthresh of each flow.
+    static constexpr bool recordGraph = true;   //!< Add the points of the graph series.
+    static constexpr bool recordQueue = true;   //!< Track the size of the bottleneck queue.
+    static constexpr bool logEvents = true;     //!< Evaluate the NS_LOG statements of each event.
+    static constexpr const char* name = "full"; //!< Name of the policy.
+};
+
+/**
+ * @brief Record the cwnd and ssthresh state needed by the statistics, without graph series.
+ * Throughput, steady state and convergence are still available.
+ */
+struct StatsTracing
+{
+    static constexpr bool recordState = true;
+    static constexpr bool recordGraph = false;
+    static constexpr bool recordQueue = false;
+    static constexpr bool logEvents = false;
+    static constexpr const char* name = "stats";
+};
+
+/**
+ * @brief Record only the bytes received by the sink, for throughput sweeps.
+ * The steady state of the flows and the cwnd metrics are not available.
+ */
+struct NoTracing
+{
+    static constexpr bool recordState = false;
+    static constexpr bool recordGraph = false;
+    static constexpr bool recordQueue = false;
+    static constexpr bool logEvents = false;
+    static constexpr const char* name = "none";
+};
+
+#ifndef P2P_TRACING_POLICY
+#define P2P_TRACING_POLICY FullTracing
+#endif
+
+/**
+ * @brief Tracing policy of this build.
+ */
+using TracingPolicy = P2P_TRACING_POLICY;
+
+#endif /* P2P_SIMULATION_TRACING_POLICY_H */
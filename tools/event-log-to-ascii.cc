@@ -0,0 +1,105 @@
+#include "../simulation/event-log-record.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/**
+ * Converts a binary event log (<prefix_file_name>.evl) to the legacy ASCII tracing format.
+ * Each line starts with the same event character, time and trace source path written by the
+ * ASCII tracing of a point-to-point device. Since the packets themselves are not stored in the
+ * log, the line ends with the size, sequence number and flags of the packet instead of its
+ * printed content.
+ *
+ * Usage: event-log-to-ascii <input.evl> [output.tr]
+ */
+
+/// Number of records read from the log at once
+static const std::size_t RECORDS_PER_READ = 65536;
+
+/**
+ * @brief Get the trace source path suffix of an event type.
+ * @param type type of the event.
+ * @return event character and path suffix of the trace source.
+ */
+static std::pair<char, const char*>
+GetTraceSource(uint8_t type)
+{
+    switch (static_cast<EventLogType>(type))
+    {
+    case EventLogType::Enqueue:
+        return {'+', "TxQueue/Enqueue"};
+    case EventLogType::Dequeue:
+        return {'-', "TxQueue/Dequeue"};
+    case EventLogType::Drop:
+        return {'d', "TxQueue/Drop"};
+    case EventLogType::Receive:
+        return {'r', "MacRx"};
+    case EventLogType::RxDrop:
+        return {'d', "PhyRxDrop"};
+    default:
+        return {'?', "Unknown"};
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::fprintf(stderr, "Usage: %s <input.evl> [output.tr]\n", argv[0]);
+        return 1;
+    }
+
+    std::FILE* input = std::fopen(argv[1], "rb");
+    if (input == nullptr)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::FILE* output = argc == 3 ? std::fopen(argv[2], "w") : stdout;
+    if (output == nullptr)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", argv[2]);
+        std::fclose(input);
+        return 1;
+    }
+
+    EventLogFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, input) != 1 ||
+        std::memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC)) != 0 ||
+        header.version != EVENT_LOG_VERSION || header.recordSize != sizeof(EventLogRecord))
+    {
+        std::fprintf(stderr, "%s is not a supported event log\n", argv[1]);
+        std::fclose(input);
+        return 1;
+    }
+
+    std::vector<EventLogRecord> records(RECORDS_PER_READ);
+    std::size_t n;
+    while ((n = std::fread(records.data(), sizeof(EventLogRecord), records.size(), input)) > 0)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const EventLogRecord& record = records[i];
+            auto [event, path] = GetTraceSource(record.type);
+            std::fprintf(output,
+                         "%c %lu.%09lu /NodeList/%u/DeviceList/%u/$ns3::PointToPointNetDevice/%s "
+                         "size=%u seq=%u flags=0x%02x\n",
+                         event,
+                         static_cast<unsigned long>(record.time / 1000000000),
+                         static_cast<unsigned long>(record.time % 1000000000),
+                         record.node,
+                         static_cast<unsigned>(record.device),
+                         path,
+                         record.size,
+                         record.seq,
+                         static_cast<unsigned>(record.flags));
+        }
+    }
+
+    std::fclose(input);
+    if (output != stdout)
+        std::fclose(output);
+    return 0;
+}
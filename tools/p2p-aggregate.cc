@@ -0,0 +1,303 @@
+#include "../simulation/statistics.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Aggregates the series of many runs, e.g. the same scenario with different --run seeds, into
+ * mean and percentile bands.
+ * Each input is the <prefix_file_name>-series.csv of a run, exported with --goodput_interval.
+ * The cwnd (mean of the flows), the goodput (sum of the flows) of each variant and the queue size
+ * of each run are resampled onto a common time grid, holding the last value of each flow, and
+ * every grid point keeps a running mean and P-square estimators of the 10th, 50th and 90th
+ * percentile across the runs. The runs are read one at a time, so the memory only depends on the
+ * grid and the number of flows of a run.
+ * The bands are written to <output>.dat and plotted with <output>.plt into <output>.svg.
+ * With --check, the percentile estimator is checked against known quantiles instead.
+ *
+ * Usage: p2p-aggregate [--grid=<s>] [--output=<prefix>] <series.csv>...
+ *        p2p-aggregate --check
+ */
+
+/**
+ * @brief Statistics of a series at a point of the grid, across the runs.
+ */
+struct GridPoint
+{
+    uint32_t n = 0;                   //!< Runs with a value at the point.
+    double mean = 0;                  //!< Running mean of the runs.
+    P2Quantile p10 = P2Quantile(0.1); //!< 10th percentile of the runs.
+    P2Quantile p50 = P2Quantile(0.5); //!< Median of the runs.
+    P2Quantile p90 = P2Quantile(0.9); //!< 90th percentile of the runs.
+};
+
+/**
+ * @brief Values of a series of a single run on the grid, summed over its flows.
+ */
+struct RunSeries
+{
+    std::vector<double> sum;     //!< Sum of the values of the flows at each point.
+    std::vector<uint32_t> count; //!< Flows with a value at each point.
+};
+
+/**
+ * @brief Last sample of a flow, held until the next one.
+ */
+struct FlowState
+{
+    std::string key;      //!< Series the flow contributes to.
+    double value = 0;     //!< Last value of the flow.
+    std::size_t next = 0; //!< First grid point not filled yet.
+};
+
+/**
+ * @brief Add a value to the grid points in [from, to) of a run series.
+ * @param series run series.
+ * @param from first grid point.
+ * @param to grid point after the last one.
+ * @param value value to add.
+ */
+static void
+Fill(RunSeries& series, std::size_t from, std::size_t to, double value)
+{
+    if (series.sum.size() < to)
+    {
+        series.sum.resize(to, 0);
+        series.count.resize(to, 0);
+    }
+    for (std::size_t i = from; i < to; i++)
+    {
+        series.sum[i] += value;
+        series.count[i]++;
+    }
+}
+
+/**
+ * @brief Read a run and resample its series onto the grid.
+ * @param fileName series file of the run.
+ * @param grid width of the grid (s).
+ * @param runSeries output parameter, series of the run by key.
+ * @return false if the file cannot be read.
+ */
+static bool
+ReadRun(const std::string& fileName, double grid, std::map<std::string, RunSeries>& runSeries)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+        return false;
+
+    std::map<std::string, FlowState> flows;
+    double endTime = 0;
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string time, flow, variant, series, value;
+        std::getline(lineStream, time, ',');
+        std::getline(lineStream, flow, ',');
+        std::getline(lineStream, variant, ',');
+        std::getline(lineStream, series, ',');
+        std::getline(lineStream, value, ',');
+        if (series != "cwnd" && series != "goodput" && series != "queue")
+            continue;
+
+        double t = std::stod(time);
+        endTime = std::max(endTime, t);
+        auto [it, inserted] = flows.try_emplace(flow + "," + series);
+        FlowState& state = it->second;
+        // The points before the sample hold the previous one
+        std::size_t until = static_cast<std::size_t>(std::ceil(t / grid));
+        if (inserted)
+        {
+            state.key = variant.empty() ? series : series + " " + variant;
+            state.next = until;
+        }
+        else if (until > state.next)
+        {
+            Fill(runSeries[state.key], state.next, until, state.value);
+            state.next = until;
+        }
+        state.value = std::stod(value);
+    }
+
+    // The last sample of each flow holds until the end of the run
+    std::size_t nPoints = static_cast<std::size_t>(endTime / grid) + 1;
+    for (const auto& [flow, state] : flows)
+    {
+        if (state.next < nPoints)
+            Fill(runSeries[state.key], state.next, nPoints, state.value);
+    }
+    return true;
+}
+
+/**
+ * @brief Check the percentile estimator against the known quantiles of some samples.
+ * The few runs of a sweep use the exact quantiles, many runs the P-square estimate.
+ * @return true if all the estimates are within the tolerance.
+ */
+static bool
+CheckQuantiles()
+{
+    struct QuantileCheck
+    {
+        uint32_t n;       //!< Observations, a permutation of 1..n scaled to (0, 1] if large.
+        double p;         //!< Quantile.
+        double expected;  //!< Known quantile.
+        double tolerance; //!< Maximum absolute error.
+    };
+    const QuantileCheck checks[] = {{5, 0.1, 1.4, 1e-9},
+                                    {5, 0.5, 3, 1e-9},
+                                    {5, 0.9, 4.6, 1e-9},
+                                    {10, 0.1, 1.9, 1e-9},
+                                    {10, 0.5, 5.5, 1e-9},
+                                    {10, 0.9, 9.1, 1e-9},
+                                    {10007, 0.1, 0.1, 0.01},
+                                    {10007, 0.5, 0.5, 0.01},
+                                    {10007, 0.9, 0.9, 0.01}};
+    bool passed = true;
+    for (const QuantileCheck& check : checks)
+    {
+        P2Quantile quantile(check.p);
+        bool large = check.n > P2Quantile::EXACT_OBSERVATIONS;
+        for (uint32_t i = 1; i <= check.n; i++)
+        {
+            // 7919 is coprime with n, so the observations are 1..n in a scrambled order
+            double value = static_cast<double>(i * 7919ULL % check.n + 1);
+            quantile.Add(large ? value / check.n : value);
+        }
+        bool ok = std::abs(quantile.Get() - check.expected) <= check.tolerance;
+        std::printf("n=%u p=%.1f expected=%g estimate=%g %s\n",
+                    check.n,
+                    check.p,
+                    check.expected,
+                    quantile.Get(),
+                    ok ? "ok" : "FAILED");
+        passed = passed && ok;
+    }
+    return passed;
+}
+
+int
+main(int argc, char* argv[])
+{
+    double grid = 0.1;
+    std::string output = "aggregate";
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--grid=", 0) == 0)
+            grid = std::stod(arg.substr(7));
+        else if (arg.rfind("--output=", 0) == 0)
+            output = arg.substr(9);
+        else if (arg == "--check")
+            return CheckQuantiles() ? 0 : 1;
+        else
+            inputs.push_back(arg);
+    }
+    if (inputs.empty() || grid <= 0)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s [--grid=<s>] [--output=<prefix>] <series.csv>...\n",
+                     argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, std::vector<GridPoint>> aggregates;
+    for (const std::string& input : inputs)
+    {
+        std::map<std::string, RunSeries> runSeries;
+        if (!ReadRun(input, grid, runSeries))
+        {
+            std::fprintf(stderr, "Cannot open %s\n", input.c_str());
+            return 1;
+        }
+        for (const auto& [key, series] : runSeries)
+        {
+            // The goodput of a variant is the sum of its flows, the cwnd their mean
+            bool summed = key.rfind("goodput", 0) == 0;
+            std::vector<GridPoint>& points = aggregates[key];
+            if (points.size() < series.sum.size())
+                points.resize(series.sum.size());
+            for (std::size_t i = 0; i < series.sum.size(); i++)
+            {
+                if (series.count[i] == 0)
+                    continue;
+                double value = summed ? series.sum[i] : series.sum[i] / series.count[i];
+                GridPoint& point = points[i];
+                point.n++;
+                point.mean += (value - point.mean) / point.n;
+                point.p10.Add(value);
+                point.p50.Add(value);
+                point.p90.Add(value);
+            }
+        }
+    }
+
+    // One block for each series, selected with "index" in gnuplot
+    std::ofstream dataFile(output + ".dat");
+    std::map<std::string, std::vector<std::pair<std::size_t, std::string>>> panels;
+    std::size_t index = 0;
+    for (const auto& [key, points] : aggregates)
+    {
+        dataFile << "# " << key << std::endl;
+        dataFile << "# time mean p10 p50 p90 runs" << std::endl;
+        for (std::size_t i = 0; i < points.size(); i++)
+        {
+            const GridPoint& point = points[i];
+            if (point.n == 0)
+                continue;
+            dataFile << i * grid << " " << point.mean << " " << point.p10.Get() << " "
+                     << point.p50.Get() << " " << point.p90.Get() << " " << point.n << std::endl;
+        }
+        dataFile << std::endl << std::endl;
+        std::string series = key.substr(0, key.find(' '));
+        std::string variant = key.size() > series.size() ? key.substr(series.size() + 1) : "";
+        panels[series].emplace_back(index++, variant);
+    }
+    dataFile.close();
+
+    const std::map<std::string, std::pair<const char*, const char*>> labels = {
+        {"cwnd", {"Congestion window", "Cwnd (segments)"}},
+        {"goodput", {"Throughput", "Goodput (Mbps)"}},
+        {"queue", {"Queue size", "Queue size (packets)"}}};
+    std::ofstream plotFile(output + ".plt");
+    plotFile << "set terminal svg size 1000," << 400 * panels.size()
+             << " dynamic background rgb \"white\"" << std::endl;
+    plotFile << "set output \"" << output << ".svg\"" << std::endl;
+    plotFile << "set multiplot layout " << panels.size() << ",1" << std::endl;
+    plotFile << "set xlabel \"Time (s)\"" << std::endl;
+    plotFile << "set key outside right" << std::endl;
+    for (const auto& [series, blocks] : panels)
+    {
+        plotFile << "set title \"" << labels.at(series).first << " (" << inputs.size()
+                 << " runs, p10-p90 band)\"" << std::endl;
+        plotFile << "set ylabel \"" << labels.at(series).second << "\"" << std::endl;
+        plotFile << "plot ";
+        for (std::size_t i = 0; i < blocks.size(); i++)
+        {
+            const auto& [block, variant] = blocks[i];
+            std::string name = variant.empty() ? series : variant;
+            plotFile << (i > 0 ? ", \\\n     " : "") << "\"" << output << ".dat\" index " << block
+                     << " using 1:3:5 with filledcurves fs transparent solid 0.25 noborder lc "
+                     << i + 1 << " title \"" << name << " p10-p90\", \\\n     \"\" index "
+                     << block << " using 1:2 with lines lw 2 lc " << i + 1 << " title \"" << name
+                     << " mean\"";
+        }
+        plotFile << std::endl;
+    }
+    plotFile << "unset multiplot" << std::endl;
+    plotFile.close();
+
+    std::printf("Aggregated %zu runs into %s.dat, plot with: gnuplot %s.plt\n",
+                inputs.size(),
+                output.c_str(),
+                output.c_str());
+    return 0;
+}
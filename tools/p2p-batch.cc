@@ -0,0 +1,91 @@
+#include "../simulation/configuration.h"
+#include "../simulation/simulation-runner.h"
+
+#include "ns3/core-module.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Runs many simulations back to back in a single process.
+ * Each non empty line of the batch file holds the options of a run, in the same format of the
+ * p2p-project command line, e.g. "--n_tcp_tahoe=2 --error_p=0.001 --run=3".
+ * At the end, the wall-clock time of each run is printed, together with the process startup
+ * time that the runs after the first one did not have to pay.
+ *
+ * Usage: p2p-batch <batch-file>
+ */
+
+NS_LOG_COMPONENT_DEFINE("P2P-Batch");
+
+/**
+ * @brief Timings of a run of the batch.
+ * The results of a run are printed by the run itself and not kept, so the memory does not grow
+ * with the length of the batch.
+ */
+struct BatchRun
+{
+    double setupTime; //!< Wall-clock time to reset and setup the run (s).
+    double runTime;   //!< Wall-clock time of the simulation itself (s).
+};
+
+int
+main(int argc, char* argv[])
+{
+    double startupTime = SimulationRunner::GetProcessStartupTime();
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <batch-file>" << std::endl;
+        return 1;
+    }
+    std::ifstream batchFile(argv[1]);
+    if (!batchFile.is_open())
+    {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    SimulationRunner runner;
+    std::vector<BatchRun> runs;
+    std::string line;
+    while (std::getline(batchFile, line))
+    {
+        std::istringstream lineStream(line);
+        std::vector<std::string> args = {argv[0]};
+        std::string arg;
+        while (lineStream >> arg)
+            args.push_back(arg);
+        if (args.size() == 1)
+            continue;
+
+        std::vector<char*> runArgv;
+        for (std::string& runArg : args)
+            runArgv.push_back(runArg.data());
+        runArgv.push_back(nullptr);
+
+        SimulationRunner::ResetGlobalState();
+        Configuration conf;
+        ParseConsoleArgs(conf, static_cast<int>(args.size()), runArgv.data());
+        NS_LOG_INFO("Run " << runs.size() << ": " << line);
+        SimulationRun run = runner.Run(conf);
+        runs.push_back({run.setupTime, run.runTime});
+    }
+
+    std::cout << "============= Batch =============" << std::endl;
+    for (std::size_t i = 0; i < runs.size(); i++)
+    {
+        std::cout << "Run: " << i << "\tSetup (s): " << runs[i].setupTime
+                  << "\tSimulation (s): " << runs[i].runTime << std::endl;
+    }
+    std::cout << "Process startup (s): " << startupTime << std::endl;
+    if (runs.size() > 1)
+    {
+        // Each run after the first would have paid its own process startup
+        std::cout << "Startup saved by the in-process runs (s): "
+                  << startupTime * (runs.size() - 1) << std::endl;
+    }
+    std::cout << "=================================" << std::endl;
+    return 0;
+}
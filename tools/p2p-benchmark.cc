@@ -0,0 +1,324 @@
+#include "../simulation/configuration.h"
+#include "../simulation/memory-accountant.h"
+#include "../simulation/simulation-runner.h"
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * Runs a catalog of reference scenarios and compares them with a baseline.
+ * For each scenario it records the wall time, the simulated events per second, the peak resident
+ * memory and the key results: the throughput of each variant, the drops of the bottleneck queue
+ * and the losses of the links. Each scenario runs in its own child process, so that the peak
+ * memory and the global state of ns-3 do not leak from one scenario to the next.
+ * With --update_baseline the metrics are written to the baseline file. Otherwise they are
+ * compared with it, and the exit code is 1 if a performance metric got worse by more than
+ * perf_tolerance or a result drifted by more than result_tolerance, both relative.
+ *
+ * Usage: p2p-benchmark [--scenarios=<a,b,...>] [--baseline=<file>] [--update_baseline]
+ *                      [--perf_tolerance=<r>] [--result_tolerance=<r>] [--list]
+ */
+
+NS_LOG_COMPONENT_DEFINE("P2P-Benchmark");
+
+/**
+ * @brief Reference scenario, with the options of the p2p-project command line.
+ */
+struct BenchmarkScenario
+{
+    const char* name;        //!< Name of the scenario.
+    const char* description; //!< What the scenario covers.
+    const char* options;     //!< Options of the scenario, as in the p2p-project command line.
+};
+
+/// Catalog of the reference scenarios
+static const BenchmarkScenario SCENARIOS[] = {
+    {"small", "1 Tahoe and 1 Reno flow", "--n_tcp_tahoe=1 --n_tcp_reno=1 --duration=10"},
+    {"medium", "50 Tahoe and 50 Reno flows", "--n_tcp_tahoe=50 --n_tcp_reno=50 --duration=10"},
+    {"star-10k",
+     "10000 flows on a star, sampled tracing",
+     "--n_tcp_tahoe=5000 --n_tcp_reno=5000 --duration=5 --trace_mode=sample "
+     "--sample_interval=0.1"},
+    {"lossy",
+     "2 Tahoe and 2 Reno flows with random losses",
+     "--n_tcp_tahoe=2 --n_tcp_reno=2 --error_p=0.01 --duration=10"},
+    {"bursty",
+     "2 Tahoe and 2 Reno flows with Gilbert-Elliott losses",
+     "--n_tcp_tahoe=2 --n_tcp_reno=2 --error_model=gilbert-elliott --duration=10"},
+    {"mixed",
+     "10 flows of each variant",
+     "--variant_mix=tahoe:10,reno:10,newreno:10,cubic:10,bbr:10 --duration=10"},
+    {"ack-path",
+     "2 Tahoe and 2 Reno flows with thinned ACKs and reverse traffic",
+     "--n_tcp_tahoe=2 --n_tcp_reno=2 --ack_thinning=true --reverse_rate=5Mbps --duration=10"},
+};
+
+/// Metrics where a higher value is a regression
+static const char* LOWER_IS_BETTER[] = {"wall_time", "peak_rss_mb"};
+/// Metrics where a lower value is a regression
+static const char* HIGHER_IS_BETTER[] = {"events_per_sec"};
+
+/**
+ * @brief Run a scenario in the current process and collect its metrics.
+ * @param scenario scenario to run.
+ * @return metrics of the scenario, by name.
+ */
+static std::map<std::string, double>
+RunScenario(const BenchmarkScenario& scenario)
+{
+    std::vector<std::string> args = {"p2p-benchmark"};
+    std::istringstream options(scenario.options);
+    std::string option;
+    while (options >> option)
+        args.push_back(option);
+    args.push_back(std::string("--prefix_file_name=benchmark-") + scenario.name);
+    std::vector<char*> argv;
+    for (std::string& arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    SimulationRunner::ResetGlobalState();
+    Configuration conf;
+    ParseConsoleArgs(conf, static_cast<int>(args.size()), argv.data());
+    SimulationRunner runner;
+    SimulationRun run = runner.Run(conf);
+
+    std::map<std::string, double> metrics;
+    metrics["wall_time"] = run.setupTime + run.runTime;
+    metrics["events"] = run.result.eventCount;
+    metrics["events_per_sec"] = run.runTime > 0 ? run.result.eventCount / run.runTime : 0;
+    metrics["peak_rss_mb"] = MemoryAccountant::ReadPeakRss() / 1e6;
+    metrics["queue_drops"] = run.result.queueDrops;
+    double linkLosses = 0;
+    for (const auto& [device, losses] : run.result.linkLosses)
+        linkLosses += losses;
+    metrics["link_losses"] = linkLosses;
+    for (const auto& [nodeId, stats] : run.result.flowStats)
+    {
+        double endTime = stats.completionTime >= 0 ? stats.completionTime : run.result.endTime;
+        double throughput = 0;
+        if (stats.startTime >= 0 && endTime > stats.startTime)
+            throughput = stats.rxBytes * 8 / (endTime - stats.startTime) / 1e6;
+        metrics["throughput_" + GetFlowVariant(conf, nodeId)] += throughput;
+    }
+    return metrics;
+}
+
+/**
+ * @brief Run a scenario in a child process.
+ * The output of the simulation is discarded, and the metrics are sent back through a pipe.
+ * @param scenario scenario to run.
+ * @param metrics output parameter, metrics of the scenario.
+ * @return false if the scenario failed.
+ */
+static bool
+RunScenarioInChild(const BenchmarkScenario& scenario, std::map<std::string, double>& metrics)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0)
+    {
+        close(fds[0]);
+        if (std::freopen("/dev/null", "w", stdout) == nullptr)
+            _exit(1);
+        std::ostringstream report;
+        report.precision(12);
+        for (const auto& [name, value] : RunScenario(scenario))
+            report << name << " " << value << "\n";
+        std::string data = report.str();
+        ssize_t written = write(fds[1], data.data(), data.size());
+        close(fds[1]);
+        _exit(written == static_cast<ssize_t>(data.size()) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    std::string data;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+        data.append(buffer, n);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return false;
+
+    std::istringstream report(data);
+    std::string name;
+    double value;
+    while (report >> name >> value)
+        metrics[name] = value;
+    return true;
+}
+
+/**
+ * @brief Check if a metric measures the performance rather than the results.
+ * @param metric name of the metric.
+ * @param direction output parameter, 1 if higher values are regressions, -1 if lower are.
+ * @return true for a performance metric.
+ */
+static bool
+IsPerformanceMetric(const std::string& metric, int& direction)
+{
+    for (const char* name : LOWER_IS_BETTER)
+    {
+        if (metric == name)
+        {
+            direction = 1;
+            return true;
+        }
+    }
+    for (const char* name : HIGHER_IS_BETTER)
+    {
+        if (metric == name)
+        {
+            direction = -1;
+            return true;
+        }
+    }
+    return false;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string scenarios = "all";
+    std::string baselineFile = "p2p-benchmark-baseline.txt";
+    bool updateBaseline = false;
+    double perfTolerance = 0.2;
+    double resultTolerance = 0.01;
+    bool list = false;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("scenarios",
+                 "Comma separated scenarios to run, all for the whole catalog",
+                 scenarios);
+    cmd.AddValue("baseline", "File with the baseline metrics", baselineFile);
+    cmd.AddValue("update_baseline", "Write the metrics to the baseline file", updateBaseline);
+    cmd.AddValue("perf_tolerance",
+                 "Relative regression of wall time, events/s and peak memory that fails the run",
+                 perfTolerance);
+    cmd.AddValue("result_tolerance",
+                 "Relative drift of the results that fails the run",
+                 resultTolerance);
+    cmd.AddValue("list", "List the scenarios of the catalog", list);
+    cmd.Parse(argc, argv);
+
+    if (list)
+    {
+        for (const BenchmarkScenario& scenario : SCENARIOS)
+            std::cout << scenario.name << "\t" << scenario.description << "\t" << scenario.options
+                      << std::endl;
+        return 0;
+    }
+
+    // Baseline: one "<scenario> <metric> <value>" line for each metric
+    std::map<std::string, std::map<std::string, double>> baseline;
+    std::ifstream baselineInput(baselineFile);
+    std::string line;
+    while (std::getline(baselineInput, line))
+    {
+        std::istringstream lineStream(line);
+        std::string scenario, metric;
+        double value;
+        if (line.empty() || line[0] == '#' || !(lineStream >> scenario >> metric >> value))
+            continue;
+        baseline[scenario][metric] = value;
+    }
+    baselineInput.close();
+
+    std::map<std::string, std::map<std::string, double>> results;
+    bool failed = false;
+    for (const BenchmarkScenario& scenario : SCENARIOS)
+    {
+        if (scenarios != "all" &&
+            ("," + scenarios + ",").find(std::string(",") + scenario.name + ",") ==
+                std::string::npos)
+            continue;
+        NS_LOG_INFO("Running " << scenario.name << ": " << scenario.options);
+        std::map<std::string, double> metrics;
+        if (!RunScenarioInChild(scenario, metrics))
+        {
+            std::cout << scenario.name << ": FAILED to run" << std::endl;
+            failed = true;
+            continue;
+        }
+        results[scenario.name] = metrics;
+
+        std::cout << "============= " << scenario.name << " =============" << std::endl;
+        const auto reference = baseline.find(scenario.name);
+        for (const auto& [metric, value] : metrics)
+        {
+            std::cout << metric << ": " << value;
+            if (updateBaseline || reference == baseline.end() ||
+                reference->second.count(metric) == 0)
+            {
+                std::cout << std::endl;
+                continue;
+            }
+            double expected = reference->second.at(metric);
+            double drift = expected != 0 ? (value - expected) / std::abs(expected)
+                                         : (value != 0 ? INFINITY : 0);
+            int direction = 0;
+            bool regression = IsPerformanceMetric(metric, direction)
+                                  ? drift * direction > perfTolerance
+                                  : std::abs(drift) > resultTolerance;
+            std::cout << "\tbaseline: " << expected << "\tdrift: " << drift * 100 << "%"
+                      << (regression ? "\tREGRESSION" : "") << std::endl;
+            failed = failed || regression;
+        }
+        if (updateBaseline || reference == baseline.end())
+            continue;
+        // A metric of the baseline the run no longer reports, e.g. the throughput of a variant
+        for (const auto& [metric, expected] : reference->second)
+        {
+            if (metrics.count(metric) != 0)
+                continue;
+            std::cout << metric << ": missing\tbaseline: " << expected << "\tREGRESSION"
+                      << std::endl;
+            failed = true;
+        }
+    }
+    std::cout << "=================================" << std::endl;
+
+    if (updateBaseline && failed)
+    {
+        std::cout << "Baseline not written, a scenario failed to run" << std::endl;
+        return 1;
+    }
+    if (updateBaseline)
+    {
+        // The scenarios not run keep their previous baseline
+        for (const auto& [scenario, metrics] : results)
+            baseline[scenario] = metrics;
+        std::ofstream baselineOutput(baselineFile);
+        baselineOutput.precision(12);
+        baselineOutput << "# <scenario> <metric> <value>, written by p2p-benchmark" << std::endl;
+        for (const auto& [scenario, metrics] : baseline)
+        {
+            for (const auto& [metric, value] : metrics)
+                baselineOutput << scenario << " " << metric << " " << value << std::endl;
+        }
+        std::cout << "Baseline written to " << baselineFile << std::endl;
+        return 0;
+    }
+    if (baseline.empty())
+        std::cout << "No baseline in " << baselineFile
+                  << ", run with --update_baseline to record one" << std::endl;
+    else
+        std::cout << (failed ? "Benchmark FAILED" : "Benchmark passed") << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Renders the gnuplot scripts left by the runs of a sweep on a pool of worker threads, one for
+ * each core by default, and writes an index page with a thumbnail of every image.
+ * The directory is scanned recursively for .plt files, e.g. the <prefix_file_name>.plt and
+ * <prefix_file_name>-goodput.plt of each run. A script is skipped when its image exists and the
+ * hash of the script and of the data files it reads is the one recorded the last time it was
+ * rendered, in <dir>/.p2p-render-cache. The scripts are run from the current directory, like the
+ * simulations that wrote them, so their output paths resolve the same way.
+ * In <dir>/index.html the images are grouped by parameter point, the prefix_file_name of the run,
+ * without the -goodput suffix.
+ *
+ * Usage: p2p-render [--jobs=<n>] [--force] [--index=<file>] [<dir>]
+ */
+
+namespace fs = std::filesystem;
+
+/// File, in the scanned directory, with the hash of each script rendered
+static const char* CACHE_FILE = ".p2p-render-cache";
+
+/**
+ * @brief Gnuplot script to render.
+ */
+struct RenderJob
+{
+    fs::path script;        //!< Gnuplot script.
+    std::string group;      //!< Parameter point the script belongs to.
+    fs::path output;        //!< Image written by the script, empty if unknown.
+    uint64_t hash = 0;      //!< Hash of the script and of its data files.
+    bool rendered = false;  //!< True if the image is up to date.
+};
+
+/**
+ * @brief Add the content of a file to a 64 bit FNV-1a hash.
+ * @param path file to hash.
+ * @param hash hash to update.
+ * @return false if the file cannot be read.
+ */
+static bool
+HashFile(const fs::path& path, uint64_t& hash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    char buffer[65536];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    {
+        for (std::streamsize i = 0; i < file.gcount(); i++)
+        {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Read the output of a script and hash it together with the data files it plots.
+ * The data files are the quoted names in the plot commands that exist, like the .dat of
+ * p2p-aggregate. The ns-3 scripts have their data inline.
+ * @param job job of the script, whose output and hash are filled.
+ * @return false if the script cannot be read.
+ */
+static bool
+ScanScript(RenderJob& job)
+{
+    std::ifstream file(job.script);
+    if (!file.is_open())
+        return false;
+
+    job.hash = 14695981039346656037ULL;
+    std::vector<fs::path> dataFiles;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::size_t open = line.find('"');
+        std::size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+            continue;
+        std::string quoted = line.substr(open + 1, close - open - 1);
+        if (line.rfind("set output", 0) == 0)
+            job.output = quoted;
+        else if (line.rfind("plot", 0) == 0 && !quoted.empty() && fs::is_regular_file(quoted))
+            dataFiles.push_back(quoted);
+    }
+    file.close();
+
+    HashFile(job.script, job.hash);
+    for (const fs::path& dataFile : dataFiles)
+        HashFile(dataFile, job.hash);
+    return true;
+}
+
+/**
+ * @brief Render a script with gnuplot.
+ * @param script gnuplot script.
+ * @return true if gnuplot succeeded.
+ */
+static bool
+Render(const fs::path& script)
+{
+    // Single quotes, with the ones in the path closed and escaped
+    std::string quoted;
+    for (char c : script.string())
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    std::string command = "gnuplot '" + quoted + "' > /dev/null 2>&1";
+    return std::system(command.c_str()) == 0;
+}
+
+/**
+ * @brief Write the index page, with the thumbnails of the images of each parameter point.
+ * @param indexFile index page.
+ * @param jobs scripts, sorted by group.
+ */
+static void
+WriteIndex(const fs::path& indexFile, const std::vector<RenderJob>& jobs)
+{
+    fs::path indexDirectory = fs::absolute(indexFile).parent_path();
+    std::ofstream index(indexFile);
+    index << "<!DOCTYPE html>" << std::endl;
+    index << "<html><head><meta charset=\"utf-8\"><title>P2P runs</title>" << std::endl;
+    index << "<style>body{font-family:sans-serif}figure{display:inline-block;margin:8px}"
+             "img{width:320px;border:1px solid #ccc}</style></head><body>"
+          << std::endl;
+    std::string group;
+    for (const RenderJob& job : jobs)
+    {
+        if (job.output.empty() || !fs::exists(job.output))
+            continue;
+        if (job.group != group)
+        {
+            index << (group.empty() ? "" : "</section>\n") << "<section><h2>" << job.group
+                  << "</h2>" << std::endl;
+            group = job.group;
+        }
+        std::string image =
+            fs::relative(fs::absolute(job.output), indexDirectory).generic_string();
+        index << "<figure><a href=\"" << image << "\"><img src=\"" << image
+              << "\" loading=\"lazy\"></a><figcaption>" << job.output.filename().string()
+              << "</figcaption></figure>" << std::endl;
+    }
+    index << (group.empty() ? "" : "</section>\n") << "</body></html>" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    unsigned int nJobs = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false;
+    fs::path directory = ".";
+    fs::path indexFile;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--jobs=", 0) == 0)
+            nJobs = std::max(1, std::stoi(arg.substr(7)));
+        else if (arg == "--force")
+            force = true;
+        else if (arg.rfind("--index=", 0) == 0)
+            indexFile = arg.substr(8);
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::fprintf(stderr,
+                         "Usage: %s [--jobs=<n>] [--force] [--index=<file>] [<dir>]\n",
+                         argv[0]);
+            return 1;
+        }
+        else
+            directory = arg;
+    }
+    if (!fs::is_directory(directory))
+    {
+        std::fprintf(stderr, "%s is not a directory\n", directory.string().c_str());
+        return 1;
+    }
+    if (indexFile.empty())
+        indexFile = directory / "index.html";
+
+    std::vector<RenderJob> jobs;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".plt")
+            continue;
+        RenderJob job;
+        job.script = entry.path();
+        // The goodput plot belongs to the same run of the main plot
+        std::string group = (entry.path().parent_path() / entry.path().stem()).generic_string();
+        const std::string suffix = "-goodput";
+        if (group.size() > suffix.size() &&
+            group.compare(group.size() - suffix.size(), suffix.size(), suffix) == 0)
+            group.erase(group.size() - suffix.size());
+        job.group = group;
+        if (ScanScript(job))
+            jobs.push_back(std::move(job));
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const RenderJob& a, const RenderJob& b) {
+        return a.group != b.group ? a.group < b.group : a.script < b.script;
+    });
+
+    // Cache: one "<hash> <script>" line for each script rendered
+    std::map<std::string, uint64_t> cache;
+    fs::path cacheFile = directory / CACHE_FILE;
+    std::ifstream cacheInput(cacheFile);
+    std::string line;
+    while (std::getline(cacheInput, line))
+    {
+        std::istringstream lineStream(line);
+        uint64_t hash;
+        std::string script;
+        if (lineStream >> std::hex >> hash && std::getline(lineStream >> std::ws, script))
+            cache[script] = hash;
+    }
+    cacheInput.close();
+
+    std::vector<RenderJob*> pending;
+    for (RenderJob& job : jobs)
+    {
+        auto cached = cache.find(job.script.generic_string());
+        job.rendered = !force && !job.output.empty() && fs::exists(job.output) &&
+                       cached != cache.end() && cached->second == job.hash;
+        if (!job.rendered)
+            pending.push_back(&job);
+    }
+
+    // Each worker takes the next pending script until there are none left
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next(0);
+    std::atomic<uint32_t> nFailed(0);
+    std::mutex outputMutex;
+    std::vector<std::thread> workers;
+    nJobs = static_cast<unsigned int>(std::min<std::size_t>(nJobs, pending.size()));
+    for (unsigned int i = 0; i < nJobs; i++)
+    {
+        workers.emplace_back([&]() {
+            for (std::size_t j = next++; j < pending.size(); j = next++)
+            {
+                RenderJob& job = *pending[j];
+                job.rendered = Render(job.script);
+                if (job.rendered)
+                    continue;
+                nFailed++;
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::fprintf(stderr, "Cannot render %s\n", job.script.string().c_str());
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // The failed scripts are left out, so they are rendered again next time
+    std::ofstream cacheOutput(cacheFile);
+    for (const RenderJob& job : jobs)
+    {
+        if (job.rendered)
+            cacheOutput << std::hex << job.hash << " " << job.script.generic_string() << std::endl;
+    }
+    cacheOutput.close();
+    WriteIndex(indexFile, jobs);
+
+    std::printf("Scripts: %zu\tRendered: %zu\tSkipped: %zu\tFailed: %u\tWorkers: %u\tTime (s): "
+                "%.2f\nIndex: %s\n",
+                jobs.size(),
+                pending.size() - nFailed,
+                jobs.size() - pending.size(),
+                nFailed.load(),
+                nJobs,
+                elapsed.count(),
+                indexFile.string().c_str());
+    return nFailed > 0 ? 1 : 0;
+}
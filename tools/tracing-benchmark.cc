@@ -0,0 +1,105 @@
+#include "../simulation/configuration.h"
+#include "../simulation/tracer.h"
+#include "../simulation/tracing-policy.h"
+
+#include "ns3/core-module.h"
+#include "ns3/traced-value.h"
+
+#include <chrono>
+
+using namespace ns3;
+
+/**
+ * Measures the per-event overhead of each tracing policy.
+ * A cwnd, an ssthresh and a queue size trace source are updated in a loop, with the callbacks of
+ * the policy connected the same way the tracer connects them in a simulation: the signals a
+ * policy does not record are not connected. The cost of an unconnected trace source is printed as
+ * the baseline.
+ *
+ * Usage: tracing-benchmark [--events=<n>]
+ */
+
+NS_LOG_COMPONENT_DEFINE("P2P-TracingBenchmark");
+
+/**
+ * @brief Update the trace sources nEvents times and measure the time taken.
+ * @param cwnd congestion window trace source.
+ * @param ssthresh slow start threshold trace source.
+ * @param queueSize queue size trace source.
+ * @param nEvents number of updates of each trace source.
+ * @return average time of an update (ns).
+ */
+static double
+UpdateTraceSources(TracedValue<uint32_t>& cwnd,
+                   TracedValue<uint32_t>& ssthresh,
+                   TracedValue<uint32_t>& queueSize,
+                   uint32_t nEvents)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 1; i <= nEvents; i++)
+    {
+        cwnd = i;
+        ssthresh = i + 1;
+        queueSize = i % 100;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (3.0 * nEvents);
+}
+
+/**
+ * @brief Measure the per-event overhead of a tracing policy.
+ * @tparam Policy tracing policy.
+ * @param conf configuration of the tracer.
+ * @param nEvents number of updates of each trace source.
+ * @return average time of an update (ns).
+ */
+template <typename Policy>
+static double
+MeasurePolicy(const Configuration& conf, uint32_t nEvents)
+{
+    Tracer tracer(conf, GraphDataUpdateType::All);
+    TracedValue<uint32_t> cwnd(conf.initial_cwnd);
+    TracedValue<uint32_t> ssthresh(conf.initial_ssthresh);
+    TracedValue<uint32_t> queueSize(0);
+    if constexpr (Policy::recordState)
+    {
+        cwnd.Connect(MakeCallback(&Tracer::CwndTracer<Policy>, &tracer),
+                     "/NodeList/0/$ns3::TcpL4Protocol/SocketList/0/CongestionWindow");
+        ssthresh.Connect(MakeCallback(&Tracer::SsThreshTracer<Policy>, &tracer),
+                         "/NodeList/0/$ns3::TcpL4Protocol/SocketList/0/SlowStartThreshold");
+    }
+    if constexpr (Policy::recordQueue)
+    {
+        queueSize.ConnectWithoutContext(MakeCallback(&Tracer::TcpQueueTracer<Policy>, &tracer));
+    }
+    return UpdateTraceSources(cwnd, ssthresh, queueSize, nEvents);
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nEvents = 1000000;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("events", "Number of updates of each trace source", nEvents);
+    cmd.Parse(argc, argv);
+
+    Configuration conf;
+    ResolveConfiguration(conf);
+
+    TracedValue<uint32_t> cwnd(0), ssthresh(0), queueSize(0);
+    double baseline = UpdateTraceSources(cwnd, ssthresh, queueSize, nEvents);
+    double full = MeasurePolicy<FullTracing>(conf, nEvents);
+    double stats = MeasurePolicy<StatsTracing>(conf, nEvents);
+    double none = MeasurePolicy<NoTracing>(conf, nEvents);
+
+    std::cout << "======== Tracing policies =======" << std::endl;
+    std::cout << "Events: " << nEvents * 3 << "\tBuild policy: " << TracingPolicy::name
+              << std::endl;
+    std::cout << "Policy\tTime per event (ns)\tOverhead (ns)" << std::endl;
+    std::cout << "unconnected\t" << baseline << "\t0" << std::endl;
+    std::cout << FullTracing::name << "\t" << full << "\t" << full - baseline << std::endl;
+    std::cout << StatsTracing::name << "\t" << stats << "\t" << stats - baseline << std::endl;
+    std::cout << NoTracing::name << "\t" << none << "\t" << none - baseline << std::endl;
+    std::cout << "=================================" << std::endl;
+    return 0;
+}